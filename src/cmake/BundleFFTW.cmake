@@ -2,7 +2,7 @@ function(bundle_fftw)
     ExternalProject_Add(fftw-bundle
         URL http://fftw.org/fftw-3.3.7.tar.gz
         URL_MD5 0d5915d7d39b3253c1cc05030d79ac47
-        CONFIGURE_COMMAND <SOURCE_DIR>/configure --prefix=<INSTALL_DIR> --enable-type-prefix --enable-mpi --enable-float --enable-shared
+        CONFIGURE_COMMAND <SOURCE_DIR>/configure --prefix=<INSTALL_DIR> --enable-type-prefix --enable-mpi --enable-threads --enable-float --enable-shared
         BUILD_COMMAND make -j4
         BUILD_IN_SOURCE 1
         BUILD_ALWAYS 0
@@ -14,6 +14,8 @@ function(bundle_fftw)
     set(FFTW_INCLUDE_DIRS "${INSTALL_DIR}/include")
     set(FFTW_LIBRARY "${INSTALL_DIR}/lib/${CMAKE_FIND_LIBRARY_PREFIXES}fftw3f${CMAKE_SHARED_LIBRARY_SUFFIX}")
     set(FFTW_MPI_LIBRARY "${INSTALL_DIR}/lib/${CMAKE_FIND_LIBRARY_PREFIXES}fftw3f_mpi${CMAKE_SHARED_LIBRARY_SUFFIX}")
+    set(FFTW_THREADS_LIBRARY "${INSTALL_DIR}/lib/${CMAKE_FIND_LIBRARY_PREFIXES}fftw3f_threads${CMAKE_SHARED_LIBRARY_SUFFIX}")
+    set(FFTW_THREADS_LIBRARY ${FFTW_THREADS_LIBRARY} PARENT_SCOPE)
 
     add_library(fftw SHARED IMPORTED)
     set_target_properties(fftw PROPERTIES IMPORTED_LOCATION ${FFTW_LIBRARY})
@@ -30,4 +32,12 @@ function(bundle_fftw)
         $<BUILD_INTERFACE:${FFTW_INCLUDE_DIRS}>
         $<INSTALL_INTERFACE:include>)
     target_link_libraries(meraxes_lib fftw fftw-mpi)
+    if(USE_FFTW_THREADS)
+        add_library(fftw-threads SHARED IMPORTED)
+        set_target_properties(fftw-threads PROPERTIES IMPORTED_LOCATION ${FFTW_THREADS_LIBRARY})
+        if(NOT EXISTS ${FFTW_THREADS_LIBRARY})
+            add_dependencies(fftw-threads fftw-bundle)
+        endif()
+        target_link_libraries(meraxes_lib fftw-threads)
+    endif()
 endfunction()
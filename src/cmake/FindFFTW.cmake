@@ -18,11 +18,18 @@ find_library(FFTW_MPI_LIBRARY NAME fftw3f_mpi
     PATHS "${FFTW_ROOT}/lib"
     HINTS ${PC_FFTW_LIBDIR} ${PC_FFTW_LIBRARY_DIRS})
 
+find_library(FFTW_THREADS_LIBRARY NAME fftw3f_threads
+    PATHS "${FFTW_ROOT}/lib"
+    HINTS ${PC_FFTW_LIBDIR} ${PC_FFTW_LIBRARY_DIRS})
+
 find_library(FFTW_LIBRARY NAME fftw3f
     PATHS "${FFTW_ROOT}/lib"
     HINTS ${PC_FFTW_LIBDIR} ${PC_FFTW_LIBRARY_DIRS})
 
 set(FFTW_LIBRARIES ${FFTW_MPI_LIBRARY} ${FFTW_LIBRARY})
+if(USE_FFTW_THREADS AND FFTW_THREADS_LIBRARY)
+    set(FFTW_LIBRARIES ${FFTW_MPI_LIBRARY} ${FFTW_THREADS_LIBRARY} ${FFTW_LIBRARY})
+endif()
 set(FFTW_INCLUDE_DIRS ${FFTW_INCLUDE_DIR})
 
 include(FindPackageHandleStandardArgs)
@@ -30,4 +37,4 @@ include(FindPackageHandleStandardArgs)
 # if all listed variables are TRUE
 find_package_handle_standard_args(FFTW DEFAULT_MSG FFTW_LIBRARY FFTW_MPI_LIBRARY FFTW_INCLUDE_DIR)
 
-mark_as_advanced(FFTW_INCLUDE_DIR FFTW_LIBRARY FFTW_MPI_LIBRARY)
+mark_as_advanced(FFTW_INCLUDE_DIR FFTW_LIBRARY FFTW_MPI_LIBRARY FFTW_THREADS_LIBRARY)
@@ -165,9 +165,7 @@ void ComputeBrightnessTemperatureBox(int snapshot)
         memcpy(vel_temp, vel, sizeof(fftwf_complex) * slab_n_complex);
 
         vel_gradient = (fftwf_complex*)vel_temp; // WATCH OUT!
-        fftwf_plan plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, vel_temp, vel_gradient, run_globals.mpi_comm, FFTW_ESTIMATE);
-        fftwf_execute(plan);
-        fftwf_destroy_plan(plan);
+        reion_fftw_execute_r2c(run_globals.reion_grids.r2c_plan, vel_temp, vel_gradient);
 
         // Remember to add the factor of VOLUME/TOT_NUM_PIXELS when converting from real space to k-space
         // Note: we will leave off factor of VOLUME, in anticipation of the inverse FFT below
@@ -182,9 +180,7 @@ void ComputeBrightnessTemperatureBox(int snapshot)
         int local_ix_start = (int)(run_globals.reion_grids.slab_ix_start[run_globals.mpi_rank]);
         velocity_gradient(vel_gradient, local_ix_start, local_nix, ReionGridDim);
 
-        plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim, vel_gradient, (float*)vel_gradient, run_globals.mpi_comm, FFTW_ESTIMATE);
-        fftwf_execute(plan);
-        fftwf_destroy_plan(plan);
+        reion_fftw_execute_c2r(run_globals.reion_grids.c2r_plan, vel_gradient, (float*)vel_gradient);
 
         if(run_globals.params.Flag_IncludePecVelsFor21cm == 1) {
 
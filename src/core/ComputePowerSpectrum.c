@@ -78,9 +78,7 @@ void Compute_PS(int snapshot)
         }
     }
 
-    fftwf_plan plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, (float *)deldel_ps, deldel_ps, run_globals.mpi_comm, FFTW_ESTIMATE);
-    fftwf_execute(plan);
-    fftwf_destroy_plan(plan);
+    reion_fftw_execute_r2c(run_globals.reion_grids.r2c_plan, (float *)deldel_ps, deldel_ps);
 
     // Calculate power spectrum
     // ------------------------------------------------------------------------------------------------------
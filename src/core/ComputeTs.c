@@ -11,6 +11,168 @@
 
 #include "XRayHeatingFunctions.c"
 
+// The unit conversion applied to the filtered SFR of each cell to give M_sol s^-1 cm^-3
+typedef struct sfr_conversion_t {
+    double pixel_volume; //!< (Mpc)^3
+    double mass_rate_unit; //!< UnitMass_in_g / UnitTime_in_s
+    double volume_unit; //!< UnitLength_in_cm^-3
+} sfr_conversion_t;
+
+static inline double smoothed_sfr_in_cgs(float sfr, const sfr_conversion_t* conv)
+{
+    // N.B. Keep this order of operations; it is the one the smoothed SFR has always been computed with
+    return (sfr / conv->pixel_volume) * conv->mass_rate_unit * conv->volume_unit / SOLAR_MASS;
+}
+
+// The smoothed SFR grids are stored in single precision when TsFloatSmoothedSFR
+// is set (see `malloc_smoothed_sfr_grids`).  In that case we store the filtered
+// SFR exactly as it comes out of the (single precision) FFT and only convert it
+// to M_sol s^-1 cm^-3 when it is read back, so evolveInt sees identical values
+// in both modes.  N.B. The converted values are far too small to be
+// represented as floats.
+static inline void set_smoothed_sfr(void* grid, int ind, float sfr, const sfr_conversion_t* conv)
+{
+    if (run_globals.params.TsFloatSmoothedSFR)
+        ((float*)grid)[ind] = sfr;
+    else
+        ((double*)grid)[ind] = smoothed_sfr_in_cgs(sfr, conv);
+}
+
+// Read all of the filter steps for one cell (these are contiguous; see `grid_index_smoothedSFR`)
+static inline void get_smoothed_sfr_cell(const void* grid, int ind_R0, int n_steps, const sfr_conversion_t* conv, double* sfr_cell)
+{
+    if (run_globals.params.TsFloatSmoothedSFR) {
+        const float* grid_R0 = (const float*)grid + ind_R0;
+        for (int R_ct = 0; R_ct < n_steps; R_ct++)
+            sfr_cell[R_ct] = smoothed_sfr_in_cgs(grid_R0[R_ct], conv);
+    } else
+        memcpy(sfr_cell, (const double*)grid + ind_R0, sizeof(double) * n_steps);
+}
+
+// Step the electron fraction and kinetic temperature of a cell over dzp using
+// the derivatives from `evolveInt`, returning the new spin temperature
+static float update_Ts_cell(double zp, double dzp, float delta, const double dansdz[], float* x_e, float* Tk, float* curr_xalpha)
+{
+    *x_e += dansdz[0] * dzp; // remember dzp is negative
+    if (*x_e > 1) // can do this late in evolution if dzp is too large
+        *x_e = (float)(1 - FRACT_FLOAT_ERR);
+    else if (*x_e < 0)
+        *x_e = 0;
+    if (*Tk < MAX_TK)
+        *Tk += dansdz[1] * dzp;
+
+    if (*Tk<0){ // spurious bahaviour of the trapazoidalintegrator. generally overcooling in underdensities
+        *Tk = (float)(TCMB*(1+zp));
+    }
+
+    return get_Ts((float)zp, delta, *Tk, *x_e, (float)dansdz[2], curr_xalpha);
+}
+
+// Linearly interpolate a frequency integral table (see `build_freq_int_tables`) in x_e for every filter step
+static inline void interp_freq_int_tbl(const double* tbl, int m_xHII_low, double frac, int n_steps, double* freq_int)
+{
+    const double* tbl_low = tbl + m_xHII_low * n_steps;
+    const double* tbl_high = tbl_low + n_steps;
+
+    for (int R_ct = 0; R_ct < n_steps; R_ct++)
+        freq_int[R_ct] = tbl_low[R_ct] + frac * (tbl_high[R_ct] - tbl_low[R_ct]);
+}
+
+// Split n_items as evenly as possible over the ranks of run_globals.mpi_comm
+static void split_over_ranks(int n_items, int* counts, int* displs)
+{
+    int mpi_size = run_globals.mpi_size;
+
+    for (int i_rank = 0; i_rank < mpi_size; i_rank++) {
+        displs[i_rank] = (int)(((long)n_items * i_rank) / mpi_size);
+        counts[i_rank] = (int)(((long)n_items * (i_rank + 1)) / mpi_size) - displs[i_rank];
+    }
+}
+
+// Build the frequency integral tables used to interpolate the heating,
+// ionisation and Lyman-alpha rates in each cell.  These are the same on every
+// rank, so rather than have every rank repeat all of the quadratures, each rank
+// evaluates a slice and the tables are then shared with an MPI_Allgatherv.
+// Each table is indexed as [x_e_ct * TsNumFilterSteps + R_ct].
+static void build_freq_int_tables(double zp,
+    const double* zpp_list,
+    double x_e_ave,
+    double collapse_fraction,
+    double filling_factor_of_HI_zp,
+    int snapshot,
+    double* freq_int_tbl_GAL[3],
+    double* freq_int_tbl_QSO[3])
+{
+    int TsNumFilterSteps = run_globals.params.TsNumFilterSteps;
+    int mpi_size = run_globals.mpi_size;
+    int mpi_rank = run_globals.mpi_rank;
+    int Flag_SeparateQSOXrays = run_globals.params.Flag_SeparateQSOXrays;
+    int n_tbl = x_int_NXHII * TsNumFilterSteps;
+    double nu_tau_one_list[TsNumFilterSteps];
+    int* counts = malloc(sizeof(int) * mpi_size);
+    int* displs = malloc(sizeof(int) * mpi_size);
+
+    // Optionally tabulate tauX over frequency first, so that the lower limits
+    // below need (at most) a single direct evaluation of tauX
+    int TsTauXTableNNu = run_globals.params.TsTauXTableNNu;
+    if (TsTauXTableNNu > 0) {
+        split_over_ranks(TsTauXTableNNu, counts, displs);
+        tabulate_tauX(displs[mpi_rank], counts[mpi_rank], zp, zpp_list, x_e_ave, snapshot);
+
+        for (int i_rank = 0; i_rank < mpi_size; i_rank++) {
+            counts[i_rank] *= TsNumFilterSteps;
+            displs[i_rank] *= TsNumFilterSteps;
+        }
+        MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, tauX_table, counts, displs, MPI_DOUBLE, run_globals.mpi_comm);
+    }
+
+    // The lower integration limits (only depend on the filtering radius)
+    split_over_ranks(TsNumFilterSteps, counts, displs);
+    tauX_table_n_fallbacks = 0;
+    for (int R_ct = displs[mpi_rank]; R_ct < displs[mpi_rank] + counts[mpi_rank]; R_ct++) {
+        if (TsTauXTableNNu > 0)
+            nu_tau_one_list[R_ct] = nu_tau_one_tabulated(R_ct, zp, zpp_list[R_ct], x_e_ave, collapse_fraction, filling_factor_of_HI_zp, snapshot);
+        else
+            nu_tau_one_list[R_ct] = nu_tau_one(zp, zpp_list[R_ct], x_e_ave, collapse_fraction, filling_factor_of_HI_zp, snapshot);
+    }
+
+    if (TsTauXTableNNu > 0) {
+        MPI_Allreduce(MPI_IN_PLACE, &tauX_table_n_fallbacks, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, run_globals.mpi_comm);
+        if (tauX_table_n_fallbacks > 0)
+            mlog("nu_tau_one fell back to the direct root solve for %llu of %d filter steps (TsTauXTableNNu = %d)", MLOG_MESG,
+                tauX_table_n_fallbacks, TsNumFilterSteps, TsTauXTableNNu);
+    }
+
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, nu_tau_one_list, counts, displs, MPI_DOUBLE, run_globals.mpi_comm);
+
+    // The frequency integrals themselves
+    split_over_ranks(n_tbl, counts, displs);
+    for (int i_tbl = displs[mpi_rank]; i_tbl < displs[mpi_rank] + counts[mpi_rank]; i_tbl++) {
+        int x_e_ct = i_tbl / TsNumFilterSteps;
+        int R_ct = i_tbl % TsNumFilterSteps;
+        double lower_int_limit_GAL = fmax(nu_tau_one_list[R_ct], run_globals.params.physics.NuXrayGalThreshold * NU_over_EV);
+
+        for (int i_kind = 0; i_kind < 3; i_kind++)
+            freq_int_tbl_GAL[i_kind][i_tbl] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_GAL, run_globals.params.physics.NuXrayGalThreshold, run_globals.params.physics.SpecIndexXrayGal, i_kind);
+
+        if (Flag_SeparateQSOXrays) {
+            double lower_int_limit_QSO = fmax(nu_tau_one_list[R_ct], run_globals.params.physics.NuXrayQSOThreshold * NU_over_EV);
+
+            for (int i_kind = 0; i_kind < 3; i_kind++)
+                freq_int_tbl_QSO[i_kind][i_tbl] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_QSO, run_globals.params.physics.NuXrayQSOThreshold, run_globals.params.physics.SpecIndexXrayQSO, i_kind);
+        }
+    }
+
+    for (int i_kind = 0; i_kind < 3; i_kind++) {
+        MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, freq_int_tbl_GAL[i_kind], counts, displs, MPI_DOUBLE, run_globals.mpi_comm);
+        if (Flag_SeparateQSOXrays)
+            MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, freq_int_tbl_QSO[i_kind], counts, displs, MPI_DOUBLE, run_globals.mpi_comm);
+    }
+
+    free(displs);
+    free(counts);
+}
+
 /*
  * This code is a re-write of the spin temperature calculation (Ts.c) within 21cmFAST.
  * Modified for usage within Meraxes by Bradley Greig.
@@ -39,9 +201,9 @@ void _ComputeTs(int snapshot)
         prev_redshift = run_globals.ZZ[snapshot-1];
     }
 
-    int i_real, i_padded, i_smoothedSFR, R_ct, x_e_ct, n_ct, m_xHII_low, m_xHII_high, NO_LIGHT;
+    int i_real, i_padded, i_smoothedSFR, R_ct, n_ct, NO_LIGHT;
 
-    double prev_zpp, prev_R, zpp, zp, lower_int_limit_GAL, lower_int_limit_QSO, filling_factor_of_HI_zp, R_factor, R, nuprime, dzp, Luminosity_converstion_factor_GAL, Luminosity_converstion_factor_QSO;
+    double prev_zpp, prev_R, zpp, zp, filling_factor_of_HI_zp, R_factor, R, nuprime, dzp, Luminosity_converstion_factor_GAL, Luminosity_converstion_factor_QSO;
     double collapse_fraction, density_over_mean;
 
     int n_pts_radii, counter, ii;
@@ -53,19 +215,16 @@ void _ComputeTs(int snapshot)
     
     float curr_xalpha;
     int TsNumFilterSteps = run_globals.params.TsNumFilterSteps;
-
-    double freq_int_heat_GAL[TsNumFilterSteps], freq_int_ion_GAL[TsNumFilterSteps], freq_int_lya_GAL[TsNumFilterSteps];
-    double freq_int_heat_QSO[TsNumFilterSteps], freq_int_ion_QSO[TsNumFilterSteps], freq_int_lya_QSO[TsNumFilterSteps];
+    int Flag_SeparateQSOXrays = run_globals.params.Flag_SeparateQSOXrays;
 
     double freq_int_heat_tbl_GAL[x_int_NXHII][TsNumFilterSteps], freq_int_ion_tbl_GAL[x_int_NXHII][TsNumFilterSteps], freq_int_lya_tbl_GAL[x_int_NXHII][TsNumFilterSteps];
     double freq_int_heat_tbl_QSO[x_int_NXHII][TsNumFilterSteps], freq_int_ion_tbl_QSO[x_int_NXHII][TsNumFilterSteps], freq_int_lya_tbl_QSO[x_int_NXHII][TsNumFilterSteps];
 
     double R_values[TsNumFilterSteps];
+    double zpp_list[TsNumFilterSteps];
 
     double dt_dzpp_list[TsNumFilterSteps];
 
-    double ans[2], dansdz[20], xHII_call;
-    double SFR_GAL[TsNumFilterSteps], SFR_QSO[TsNumFilterSteps];
 
     float* x_e_box = run_globals.reion_grids.x_e_box;
     float* x_e_box_prev = run_globals.reion_grids.x_e_box_prev;
@@ -80,9 +239,7 @@ void _ComputeTs(int snapshot)
 
     fftwf_complex* sfr_unfiltered = (fftwf_complex*)sfr_temp; // WATCH OUT!
     fftwf_complex* sfr_filtered = run_globals.reion_grids.sfr_filtered;
-    fftwf_plan plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, sfr_temp, sfr_unfiltered, run_globals.mpi_comm, FFTW_ESTIMATE);
-    fftwf_execute(plan);
-    fftwf_destroy_plan(plan);
+    reion_fftw_execute_r2c(run_globals.reion_grids.r2c_plan, sfr_temp, sfr_unfiltered);
 
     // Remember to add the factor of VOLUME/TOT_NUM_PIXELS when converting from real space to k-space
     // Note: we will leave off factor of VOLUME, in anticipation of the inverse FFT below
@@ -91,13 +248,8 @@ void _ComputeTs(int snapshot)
         sfr_unfiltered[ii] /= total_n_cells;
     }
 
-    double* SMOOTHED_SFR_GAL = run_globals.reion_grids.SMOOTHED_SFR_GAL;
-    double* SMOOTHED_SFR_QSO;
-    if(run_globals.params.Flag_SeparateQSOXrays) {
-        SMOOTHED_SFR_QSO = run_globals.reion_grids.SMOOTHED_SFR_QSO;
-    }
-
-    // Initialise the RECFAST, electron rate tables
+    // Allocate the per-call filter step arrays (the RECFAST, electron rate
+    // tables are read once in `malloc_reionization_grids`)
     init_heat();
 
     x_e_ave = 0.0;
@@ -156,6 +308,20 @@ void _ComputeTs(int snapshot)
     }
     else {
 
+        // In lean memory mode the smoothed SFR grids are only allocated for this branch
+        if (run_globals.params.ReionLeanMemory)
+            malloc_smoothed_sfr_grids();
+
+        void* SMOOTHED_SFR_GAL = run_globals.reion_grids.SMOOTHED_SFR_GAL;
+        void* SMOOTHED_SFR_QSO = run_globals.reion_grids.SMOOTHED_SFR_QSO;
+
+        // Converts the filtered SFR in each cell to M_sol s^-1 cm^-3
+        sfr_conversion_t sfr_conversion = {
+            .pixel_volume = pixel_volume,
+            .mass_rate_unit = units->UnitMass_in_g / units->UnitTime_in_s,
+            .volume_unit = pow( units->UnitLength_in_cm, -3. ),
+        };
+
         collapse_fraction = 0.;
 
         // Setup starting radius (minimum) and scaling to obtaining the maximum filtering radius for the X-ray background
@@ -176,9 +342,7 @@ void _ComputeTs(int snapshot)
             }
 
             // inverse fourier transform back to real space
-            plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim, sfr_filtered, (float*)sfr_filtered, run_globals.mpi_comm, FFTW_ESTIMATE);
-            fftwf_execute(plan);
-            fftwf_destroy_plan(plan);
+            reion_fftw_execute_c2r(run_globals.reion_grids.c2r_plan, sfr_filtered, (float*)sfr_filtered);
 
             // Compute and store the collapse fraction and average electron fraction. Necessary for evaluating the integrals back along the light-cone.
             // Need the non-smoothed version, hence this is only done for R_ct == 0.
@@ -193,12 +357,10 @@ void _ComputeTs(int snapshot)
 
                             ((float*)sfr_filtered)[i_padded] = fmaxf(((float*)sfr_filtered)[i_padded], 0.0);
 
-                            SMOOTHED_SFR_GAL[i_smoothedSFR] = ( ((float*)sfr_filtered)[i_padded] / pixel_volume )
-                                * (units->UnitMass_in_g / units->UnitTime_in_s) * pow( units->UnitLength_in_cm, -3. )/ SOLAR_MASS;
+                            set_smoothed_sfr(SMOOTHED_SFR_GAL, i_smoothedSFR, ((float*)sfr_filtered)[i_padded], &sfr_conversion);
 
                             if(run_globals.params.Flag_SeparateQSOXrays) {
-                                SMOOTHED_SFR_QSO[i_smoothedSFR] = ( ((float*)sfr_filtered)[i_padded] / pixel_volume )
-                                    * (units->UnitMass_in_g / units->UnitTime_in_s) * pow( units->UnitLength_in_cm, -3. )/ SOLAR_MASS;
+                                set_smoothed_sfr(SMOOTHED_SFR_QSO, i_smoothedSFR, ((float*)sfr_filtered)[i_padded], &sfr_conversion);
                             }
 
                             density_over_mean = 1.0 + run_globals.reion_grids.deltax[i_padded];
@@ -231,12 +393,10 @@ void _ComputeTs(int snapshot)
 
                             ((float*)sfr_filtered)[i_padded] = fmaxf(((float*)sfr_filtered)[i_padded], 0.0);
 
-                            SMOOTHED_SFR_GAL[i_smoothedSFR] = (((float*)sfr_filtered)[i_padded] / pixel_volume )
-                                * (units->UnitMass_in_g / units->UnitTime_in_s) * pow( units->UnitLength_in_cm, -3. )/ SOLAR_MASS;
+                            set_smoothed_sfr(SMOOTHED_SFR_GAL, i_smoothedSFR, ((float*)sfr_filtered)[i_padded], &sfr_conversion);
 
                             if(run_globals.params.Flag_SeparateQSOXrays) {
-                                SMOOTHED_SFR_QSO[i_smoothedSFR] = ( ((float*)sfr_filtered)[i_padded] / pixel_volume )
-                                    * (units->UnitMass_in_g / units->UnitTime_in_s) * pow( units->UnitLength_in_cm, -3. )/ SOLAR_MASS;
+                                set_smoothed_sfr(SMOOTHED_SFR_QSO, i_smoothedSFR, ((float*)sfr_filtered)[i_padded], &sfr_conversion);
                             }
 
                         }
@@ -271,28 +431,7 @@ void _ComputeTs(int snapshot)
             zpp = (zpp_edge[R_ct]+prev_zpp)*0.5; // average redshift value of shell: z'' + 0.5 * dz''
 
             dt_dzpp_list[R_ct] = dtdz((float)zpp);
-
-            filling_factor_of_HI_zp = 1. - ReionEfficiency * collapse_fraction / (1.0 - x_e_ave);
-
-            lower_int_limit_GAL = fmax(nu_tau_one(zp, zpp, x_e_ave, collapse_fraction, filling_factor_of_HI_zp, snapshot), run_globals.params.physics.NuXrayGalThreshold*NU_over_EV);
-
-            if(run_globals.params.Flag_SeparateQSOXrays) {
-                lower_int_limit_QSO = fmax(nu_tau_one(zp, zpp, x_e_ave, collapse_fraction, filling_factor_of_HI_zp, snapshot), run_globals.params.physics.NuXrayQSOThreshold*NU_over_EV);
-            }
-
-            if (filling_factor_of_HI_zp < 0) filling_factor_of_HI_zp = 0; // for global evol; nu_tau_one above treats negative (post_reionization) inferred filling factors properly
-
-            for (x_e_ct = 0; x_e_ct < x_int_NXHII; x_e_ct++){
-                freq_int_heat_tbl_GAL[x_e_ct][R_ct] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_GAL, run_globals.params.physics.NuXrayGalThreshold, run_globals.params.physics.SpecIndexXrayGal, 0);
-                freq_int_ion_tbl_GAL[x_e_ct][R_ct] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_GAL, run_globals.params.physics.NuXrayGalThreshold, run_globals.params.physics.SpecIndexXrayGal, 1);
-                freq_int_lya_tbl_GAL[x_e_ct][R_ct] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_GAL, run_globals.params.physics.NuXrayGalThreshold, run_globals.params.physics.SpecIndexXrayGal, 2);
-
-                if(run_globals.params.Flag_SeparateQSOXrays)	{
-                    freq_int_heat_tbl_QSO[x_e_ct][R_ct] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_QSO, run_globals.params.physics.NuXrayQSOThreshold, run_globals.params.physics.SpecIndexXrayQSO, 0);
-                    freq_int_ion_tbl_QSO[x_e_ct][R_ct] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_QSO, run_globals.params.physics.NuXrayQSOThreshold, run_globals.params.physics.SpecIndexXrayQSO, 1);
-                    freq_int_lya_tbl_QSO[x_e_ct][R_ct] = integrate_over_nu(zp, x_int_XHII[x_e_ct], lower_int_limit_QSO, run_globals.params.physics.NuXrayQSOThreshold, run_globals.params.physics.SpecIndexXrayQSO, 2);
-                }
-            }
+            zpp_list[R_ct] = zpp;
 
             // and create the sum over Lya transitions from direct Lyn flux
             sum_lyn[R_ct] = 0;
@@ -350,6 +489,16 @@ void _ComputeTs(int snapshot)
             
         }
 
+        // nu_tau_one treats negative (post_reionization) inferred filling factors properly
+        filling_factor_of_HI_zp = 1. - ReionEfficiency * collapse_fraction / (1.0 - x_e_ave);
+
+        {
+            double* freq_int_tbl_GAL[3] = { &freq_int_heat_tbl_GAL[0][0], &freq_int_ion_tbl_GAL[0][0], &freq_int_lya_tbl_GAL[0][0] };
+            double* freq_int_tbl_QSO[3] = { &freq_int_heat_tbl_QSO[0][0], &freq_int_ion_tbl_QSO[0][0], &freq_int_lya_tbl_QSO[0][0] };
+
+            build_freq_int_tables(zp, zpp_list, x_e_ave, collapse_fraction, filling_factor_of_HI_zp, snapshot, freq_int_tbl_GAL, freq_int_tbl_QSO);
+        }
+
         growth_factor_zp = dicke(zp);
         dgrowth_factor_dzp = ddicke_dz(zp);
         dt_dzp = dtdz((float)zp);
@@ -403,90 +552,60 @@ void _ComputeTs(int snapshot)
             const_zp_prefactor_QSO = ( run_globals.params.physics.LXrayQSO * Luminosity_converstion_factor_QSO ) / (run_globals.params.physics.NuXrayQSOThreshold*NU_over_EV) * C * pow(1+zp, run_globals.params.physics.SpecIndexXrayQSO+3);
         }
 
-        //interpolate to correct nu integral value based on the cell's ionization state
+        // evolveInt has always used the dt_dzpp of the last filter step
+        dt_dzpp = dt_dzpp_list[TsNumFilterSteps - 1];
+        init_zpp_weights((float)zp);
+
+        // Each cell is independent, so this loop may be threaded (see USE_OPENMP)
+#ifdef USE_OPENMP
+#pragma omp parallel for collapse(3) private(i_real, i_padded, i_smoothedSFR, curr_xalpha) reduction(+ : J_alpha_ave, xalpha_ave, Xheat_ave, Xion_ave)
+#endif
         for (int ix = 0; ix < local_nix; ix++)
             for (int iy = 0; iy < ReionGridDim; iy++)
                 for (int iz = 0; iz < ReionGridDim; iz++) {
                     i_real = grid_index(ix, iy, iz, ReionGridDim, INDEX_REAL);
                     i_padded = grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED);
+                    i_smoothedSFR = grid_index_smoothedSFR(0, ix, iy, iz, TsNumFilterSteps, ReionGridDim);
+
+                    double SFR_GAL[TsNumFilterSteps], SFR_QSO[TsNumFilterSteps];
+                    double freq_int_heat_GAL[TsNumFilterSteps], freq_int_ion_GAL[TsNumFilterSteps], freq_int_lya_GAL[TsNumFilterSteps];
+                    double freq_int_heat_QSO[TsNumFilterSteps], freq_int_ion_QSO[TsNumFilterSteps], freq_int_lya_QSO[TsNumFilterSteps];
+                    double ans[2], dansdz[20];
 
                     ans[0] = x_e_box_prev[i_padded];
                     ans[1] = Tk_box[i_real];
 
-                    for (R_ct=0; R_ct<TsNumFilterSteps; R_ct++){
-                        i_smoothedSFR = grid_index_smoothedSFR(R_ct, ix, iy, iz, TsNumFilterSteps, ReionGridDim);
-
-                        SFR_GAL[R_ct] = SMOOTHED_SFR_GAL[i_smoothedSFR];
-
-                        if(run_globals.params.Flag_SeparateQSOXrays) {
-                            SFR_QSO[R_ct] = SMOOTHED_SFR_QSO[i_smoothedSFR];
-                        }
-
-                        xHII_call = x_e_box_prev[i_padded];
-
-                        dt_dzpp = dt_dzpp_list[R_ct];
-
-                        // Check if ionized fraction is within boundaries; if not, adjust to be within
-                        if (xHII_call > x_int_XHII[x_int_NXHII-1]*0.999) {
-                            xHII_call = x_int_XHII[x_int_NXHII-1]*0.999;
-                        } else if (xHII_call < x_int_XHII[0]) {
-                            xHII_call = 1.001*x_int_XHII[0];
-                        }
-
-                        m_xHII_low = locate_xHII_index((float)xHII_call);
-                        m_xHII_high = m_xHII_low + 1;
-
-                        // heat
-                        freq_int_heat_GAL[R_ct] = (freq_int_heat_tbl_GAL[m_xHII_high][R_ct] - freq_int_heat_tbl_GAL[m_xHII_low][R_ct]) / (x_int_XHII[m_xHII_high] - x_int_XHII[m_xHII_low]);
-                        freq_int_heat_GAL[R_ct] *= (xHII_call - x_int_XHII[m_xHII_low]);
-                        freq_int_heat_GAL[R_ct] += freq_int_heat_tbl_GAL[m_xHII_low][R_ct];
-
-                        // ionization
-                        freq_int_ion_GAL[R_ct] = (freq_int_ion_tbl_GAL[m_xHII_high][R_ct] - freq_int_ion_tbl_GAL[m_xHII_low][R_ct]) / (x_int_XHII[m_xHII_high] - x_int_XHII[m_xHII_low]);
-                        freq_int_ion_GAL[R_ct] *= (xHII_call - x_int_XHII[m_xHII_low]);
-                        freq_int_ion_GAL[R_ct] += freq_int_ion_tbl_GAL[m_xHII_low][R_ct];
+                    get_smoothed_sfr_cell(SMOOTHED_SFR_GAL, i_smoothedSFR, TsNumFilterSteps, &sfr_conversion, SFR_GAL);
+                    if (Flag_SeparateQSOXrays)
+                        get_smoothed_sfr_cell(SMOOTHED_SFR_QSO, i_smoothedSFR, TsNumFilterSteps, &sfr_conversion, SFR_QSO);
 
-                        // lya
-                        freq_int_lya_GAL[R_ct] = (freq_int_lya_tbl_GAL[m_xHII_high][R_ct] - freq_int_lya_tbl_GAL[m_xHII_low][R_ct]) / (x_int_XHII[m_xHII_high] - x_int_XHII[m_xHII_low]);
-                        freq_int_lya_GAL[R_ct] *= (xHII_call - x_int_XHII[m_xHII_low]);
-                        freq_int_lya_GAL[R_ct] += freq_int_lya_tbl_GAL[m_xHII_low][R_ct];
-
-                        if(run_globals.params.Flag_SeparateQSOXrays) {
+                    // Check if ionized fraction is within boundaries; if not, adjust to be within
+                    double xHII_call = x_e_box_prev[i_padded];
+                    if (xHII_call > x_int_XHII[x_int_NXHII-1]*0.999) {
+                        xHII_call = x_int_XHII[x_int_NXHII-1]*0.999;
+                    } else if (xHII_call < x_int_XHII[0]) {
+                        xHII_call = 1.001*x_int_XHII[0];
+                    }
 
-                            // heat
-                            freq_int_heat_QSO[R_ct] = (freq_int_heat_tbl_QSO[m_xHII_high][R_ct] - freq_int_heat_tbl_QSO[m_xHII_low][R_ct]) / (x_int_XHII[m_xHII_high] - x_int_XHII[m_xHII_low]);
-                            freq_int_heat_QSO[R_ct] *= (xHII_call - x_int_XHII[m_xHII_low]);
-                            freq_int_heat_QSO[R_ct] += freq_int_heat_tbl_QSO[m_xHII_low][R_ct];
+                    //interpolate to correct nu integral value based on the cell's ionization state
+                    int m_xHII_low = locate_xHII_index((float)xHII_call);
+                    double frac = (xHII_call - x_int_XHII[m_xHII_low]) / (x_int_XHII[m_xHII_low + 1] - x_int_XHII[m_xHII_low]);
 
-                            // ionization
-                            freq_int_ion_QSO[R_ct] = (freq_int_ion_tbl_QSO[m_xHII_high][R_ct] - freq_int_ion_tbl_QSO[m_xHII_low][R_ct]) / (x_int_XHII[m_xHII_high] - x_int_XHII[m_xHII_low]);
-                            freq_int_ion_QSO[R_ct] *= (xHII_call - x_int_XHII[m_xHII_low]);
-                            freq_int_ion_QSO[R_ct] += freq_int_ion_tbl_QSO[m_xHII_low][R_ct];
+                    interp_freq_int_tbl(&freq_int_heat_tbl_GAL[0][0], m_xHII_low, frac, TsNumFilterSteps, freq_int_heat_GAL);
+                    interp_freq_int_tbl(&freq_int_ion_tbl_GAL[0][0], m_xHII_low, frac, TsNumFilterSteps, freq_int_ion_GAL);
+                    interp_freq_int_tbl(&freq_int_lya_tbl_GAL[0][0], m_xHII_low, frac, TsNumFilterSteps, freq_int_lya_GAL);
 
-                            // lya
-                            freq_int_lya_QSO[R_ct] = (freq_int_lya_tbl_QSO[m_xHII_high][R_ct] - freq_int_lya_tbl_QSO[m_xHII_low][R_ct]) / (x_int_XHII[m_xHII_high] - x_int_XHII[m_xHII_low]);
-                            freq_int_lya_QSO[R_ct] *= (xHII_call - x_int_XHII[m_xHII_low]);
-                            freq_int_lya_QSO[R_ct] += freq_int_lya_tbl_QSO[m_xHII_low][R_ct];
-                        }
+                    if (Flag_SeparateQSOXrays) {
+                        interp_freq_int_tbl(&freq_int_heat_tbl_QSO[0][0], m_xHII_low, frac, TsNumFilterSteps, freq_int_heat_QSO);
+                        interp_freq_int_tbl(&freq_int_ion_tbl_QSO[0][0], m_xHII_low, frac, TsNumFilterSteps, freq_int_ion_QSO);
+                        interp_freq_int_tbl(&freq_int_lya_tbl_QSO[0][0], m_xHII_low, frac, TsNumFilterSteps, freq_int_lya_QSO);
                     }
 
                     // Perform the calculation of the heating/ionisation integrals, updating relevant quantities etc.
                     evolveInt((float)zp, run_globals.reion_grids.deltax[i_padded], SFR_GAL, SFR_QSO, freq_int_heat_GAL, freq_int_ion_GAL, freq_int_lya_GAL, freq_int_heat_QSO, freq_int_ion_QSO, freq_int_lya_QSO, NO_LIGHT, ans, dansdz);
 
-                    x_e_box_prev[i_padded] += dansdz[0] * dzp; // remember dzp is negative
-                    if (x_e_box_prev[i_padded] > 1) // can do this late in evolution if dzp is too large
-                        x_e_box_prev[i_padded] = (float)(1 - FRACT_FLOAT_ERR);
-                    else if (x_e_box_prev[i_padded] < 0)
-                        x_e_box_prev[i_padded] = 0;
-                    if (Tk_box[i_real] < MAX_TK)
-                        Tk_box[i_real] += dansdz[1] * dzp;
-
-                    if (Tk_box[i_real]<0){ // spurious bahaviour of the trapazoidalintegrator. generally overcooling in underdensities
-                        Tk_box[i_real] = (float)(TCMB*(1+zp));
-                    }
-
-                    TS_box[i_real] = get_Ts((float)zp, run_globals.reion_grids.deltax[i_padded], Tk_box[i_real], x_e_box_prev[i_padded],
-                                            (float)dansdz[2], &curr_xalpha);
+                    TS_box[i_real] = update_Ts_cell(zp, dzp, run_globals.reion_grids.deltax[i_padded], dansdz,
+                                                    &x_e_box_prev[i_padded], &Tk_box[i_real], &curr_xalpha);
 
                     J_alpha_ave += dansdz[2];
                     xalpha_ave += curr_xalpha;
@@ -508,6 +627,9 @@ void _ComputeTs(int snapshot)
         run_globals.reion_grids.volume_ave_xalpha = xalpha_ave;
         run_globals.reion_grids.volume_ave_Xheat = Xheat_ave;
         run_globals.reion_grids.volume_ave_Xion = Xion_ave;
+
+        if (run_globals.params.ReionLeanMemory)
+            free_smoothed_sfr_grids();
     }
 
     memcpy(x_e_box, x_e_box_prev, sizeof(fftwf_complex) * slab_n_complex);
@@ -520,6 +642,7 @@ void _ComputeTs(int snapshot)
         for (int iy = 0; iy < ReionGridDim; iy++)
             for (int iz = 0; iz < ReionGridDim; iz++) {
                 i_real = grid_index(ix, iy, iz, ReionGridDim, INDEX_REAL);
+                i_padded = grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED);
 
                 Ave_Ts += (double)TS_box[i_real];
                 Ave_Tk += (double)Tk_box[i_real];
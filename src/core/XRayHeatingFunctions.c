@@ -12,6 +12,8 @@
 #include <limits.h>
 #include <math.h>
 #include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // DEBUG
 #include <hdf5.h>
@@ -33,6 +35,14 @@
 #define _x_int_VARIABLES_DEFINED
 #endif
 
+// The GSL interpolation accelerators used by the kappa_10 tables are not
+// thread safe, so they are bypassed when the ComputeTs cell loop is threaded
+#ifdef USE_OPENMP
+#define KAPPA_ACCEL(acc) NULL
+#else
+#define KAPPA_ACCEL(acc) (acc)
+#endif
+
 #define Pop (int) (2)
 #define Pop2_ion run_globals.params.physics.ReionNionPhotPerBary
 #define Pop3_ion (float) (44021)
@@ -46,6 +56,9 @@
 /* Define some global variables; yeah i know it isn't "good practice" but doesn't matter */
 //double zpp_edge[run_globals.params.NUM_FILTER_STEPS_FOR_Ts], sigma_atR[run_globals.params.NUM_FILTER_STEPS_FOR_Ts], sigma_Tmin[run_globals.params.NUM_FILTER_STEPS_FOR_Ts], ST_over_PS[run_globals.params.NUM_FILTER_STEPS_FOR_Ts], sum_lyn[run_globals.params.NUM_FILTER_STEPS_FOR_Ts];
 double *zpp_edge, *sigma_atR, *sigma_Tmin, *ST_over_PS, *sum_lyn;
+double *zpp_weight_GAL, *zpp_weight_QSO, *lya_weight;
+double *tauX_table;
+unsigned long long tauX_table_n_fallbacks; //!< calls of nu_tau_one_tabulated that fell back to nu_tau_one
 unsigned long long box_ct;
 double const_zp_prefactor_GAL, const_zp_prefactor_QSO, dt_dzp, dt_dzpp, x_e_ave;
 double growth_factor_zp, dgrowth_factor_dzp, PS_ION_EFF;
@@ -95,6 +108,15 @@ int init_heat();
 /* destruction/deallocation routine */
 void destruct_heat();
 
+/* precompute the redshift dependent z'' integration weights used by evolveInt */
+void init_zpp_weights(float zp);
+
+/* read the RECFAST, kappa_10, stellar spectra and x_int tables (once per run) */
+void init_heat_tables();
+
+/* free the splines set up by init_heat_tables */
+void free_heat_tables();
+
 /* returns the spectral emissity */
 double spectral_emissivity(double nu_norm, int flag);
 
@@ -111,12 +133,16 @@ double HeI_ion_crosssec(double nu);
 /* Calculates the optical depth for a photon arriving at z = zp with frequency nu, emitted at z = zpp */
 double tauX(double nu, double x_e, double zp, double zpp, double fcoll, double HI_filling_factor_zp, int snap_i);
 
+/* tabulate tauX over frequency for each of the shells in zpp_list (see `nu_tau_one_tabulated`) */
+void tabulate_tauX(int i_nu_start, int n_nu, double zp, const double* zpp_list, double x_e, int snap_i);
+
 /* The total weighted HI + HeI + HeII  cross-section in pcm^-2 */
 double species_weighted_x_ray_cross_section(double nu, double x_e);
 
 /* Returns the frequency threshold where \tau = 1 between zp and zpp,
    in the IGM with mean electron fraction x_e */
 double nu_tau_one(double zp, double zpp, double x_e, double fcoll, double HI_filling_factor_zp, int snap_i);
+double nu_tau_one_tabulated(int R_ct, double zp, double zpp, double x_e, double fcoll, double HI_filling_factor_zp, int snap_i);
 
 /* Main integral driver for the frequency integral in the evolution equations */
 double integrate_over_nu(double zp, double local_x_e, double lower_int_limit, double thresh_energy, double spec_index, int FLAG);
@@ -155,6 +181,135 @@ double interpolate_fcoll(double redshift, int snap_i);
 
 
 
+// The GSL integration workspaces and root solver used by tauX, nu_tau_one and
+// integrate_over_nu are allocated on first use and then reused for every
+// subsequent call.  Each thread has its own set, so these functions remain safe
+// to call concurrently.  Every set is also recorded in xray_workspaces so that
+// `free_xray_workspaces` can free those of all threads, not just the caller's.
+#define XRAY_WORKSPACE_SIZE 1000
+typedef struct xray_workspaces_t {
+    gsl_integration_workspace* tauX;
+    gsl_integration_workspace* nu_integral;
+    gsl_root_fsolver* nu_tau_one_solver;
+} xray_workspaces_t;
+
+static xray_workspaces_t** xray_workspaces = NULL;
+static int n_xray_workspaces = 0;
+
+// Incremented by `free_xray_workspaces`, which invalidates every thread's set
+static int xray_workspaces_generation = 1;
+static __thread xray_workspaces_t* thread_xray_workspaces = NULL;
+static __thread int thread_xray_workspaces_generation = 0;
+
+static xray_workspaces_t* get_xray_workspaces()
+{
+    if (thread_xray_workspaces_generation != xray_workspaces_generation) {
+        xray_workspaces_t* ws = calloc(1, sizeof(xray_workspaces_t));
+        if (ws == NULL) {
+            mlog_error("Unable to allocate X-ray heating workspaces.");
+            ABORT(EXIT_FAILURE);
+        }
+
+        bool recorded = false;
+#ifdef USE_OPENMP
+#pragma omp critical(xray_workspaces)
+#endif
+        {
+            xray_workspaces_t** list = realloc(xray_workspaces, sizeof(xray_workspaces_t*) * (n_xray_workspaces + 1));
+            if (list != NULL) {
+                xray_workspaces = list;
+                xray_workspaces[n_xray_workspaces++] = ws;
+                recorded = true;
+            }
+        }
+        if (!recorded) {
+            mlog_error("Unable to record X-ray heating workspaces.");
+            ABORT(EXIT_FAILURE);
+        }
+
+        thread_xray_workspaces = ws;
+        thread_xray_workspaces_generation = xray_workspaces_generation;
+    }
+
+    return thread_xray_workspaces;
+}
+
+static gsl_integration_workspace* get_integration_workspace(gsl_integration_workspace** workspace)
+{
+    if (*workspace == NULL) {
+        *workspace = gsl_integration_workspace_alloc(XRAY_WORKSPACE_SIZE);
+        if (*workspace == NULL) {
+            mlog_error("Unable to allocate X-ray heating integration workspace.");
+            ABORT(EXIT_FAILURE);
+        }
+    }
+
+    return *workspace;
+}
+
+// N.B. Must be called outside of any parallel region
+static void free_xray_workspaces()
+{
+    for (int ii = 0; ii < n_xray_workspaces; ii++) {
+        xray_workspaces_t* ws = xray_workspaces[ii];
+
+        if (ws->nu_tau_one_solver != NULL)
+            gsl_root_fsolver_free(ws->nu_tau_one_solver);
+        if (ws->nu_integral != NULL)
+            gsl_integration_workspace_free(ws->nu_integral);
+        if (ws->tauX != NULL)
+            gsl_integration_workspace_free(ws->tauX);
+        free(ws);
+    }
+
+    free(xray_workspaces);
+    xray_workspaces = NULL;
+    n_xray_workspaces = 0;
+    xray_workspaces_generation++;
+}
+
+// The tables read here do not depend on the snapshot, so they are read and
+// broadcast once per run rather than on every call to ComputeTs.
+static bool heat_tables_initialised = false;
+
+void init_heat_tables()
+{
+    if (heat_tables_initialised)
+        return;
+
+    mlog("Reading X-ray heating tables...", MLOG_OPEN | MLOG_TIMERSTART);
+
+    kappa_10(1.0,1);
+    kappa_10_elec(1.0,1);
+    kappa_10_pH(1.0,1);
+    T_RECFAST(100, 1);
+    xion_RECFAST(100, 1);
+    spectral_emissivity(0,1);
+
+    initialize_interp_arrays();
+
+    heat_tables_initialised = true;
+
+    mlog("...done", MLOG_CLOSE | MLOG_TIMERSTOP);
+}
+
+void free_heat_tables()
+{
+    if (!heat_tables_initialised)
+        return;
+
+    spectral_emissivity(0.0, 2);
+    xion_RECFAST(100.0,2);
+    T_RECFAST(100.0,2);
+    kappa_10_pH(1.0,2);
+    kappa_10_elec(1.0,2);
+    kappa_10(1.0,2);
+
+    free_xray_workspaces();
+
+    heat_tables_initialised = false;
+}
+
 int init_heat()
 {
 
@@ -164,21 +319,15 @@ int init_heat()
     sigma_Tmin = calloc(TsNumFilterSteps, sizeof(double));
     ST_over_PS = calloc(TsNumFilterSteps, sizeof(double));
     sum_lyn = calloc(TsNumFilterSteps, sizeof(double));
+    zpp_weight_GAL = calloc(TsNumFilterSteps, sizeof(double));
+    zpp_weight_QSO = calloc(TsNumFilterSteps, sizeof(double));
+    lya_weight = calloc(TsNumFilterSteps, sizeof(double));
 
+    if (run_globals.params.TsTauXTableNNu > 0)
+        tauX_table = calloc((size_t)run_globals.params.TsTauXTableNNu * TsNumFilterSteps, sizeof(double));
 
-    kappa_10(1.0,1);
-    if( kappa_10_elec(1.0,1) < 0)
-        return -2;
-    if( kappa_10_pH(1.0,1) < 0)
-        return -3;
-    if (T_RECFAST(100, 1) < 0)
-        return -4;
-    if (xion_RECFAST(100, 1) < 0)
-        return -5;
-    if (spectral_emissivity(0,1) < 0)
-        return -6;
-
-    initialize_interp_arrays();
+    // A no-op once the tables have been read in `malloc_reionization_grids`
+    init_heat_tables();
 
     return 0;
 }
@@ -186,13 +335,11 @@ int init_heat()
 
 void destruct_heat()
 {
-  spectral_emissivity(0.0, 2);
-  xion_RECFAST(100.0,2);
-  T_RECFAST(100.0,2);
-  kappa_10_pH(1.0,2);
-  kappa_10_elec(1.0,2);
-  kappa_10(1.0,2);
-
+  free(tauX_table);
+  tauX_table = NULL;
+  free(lya_weight);
+  free(zpp_weight_QSO);
+  free(zpp_weight_GAL);
   free(sum_lyn);
   free(ST_over_PS);
   free(sigma_Tmin);
@@ -225,8 +372,8 @@ double T_RECFAST(float z, int flag)
 
             // Read in the data
             if (!(F = fopen(fname, "r"))){
-                mlog("T_RECFAST: Unable to open file: %s for reading\nAborting\n",MLOG_MESG, fname);
-                return -1;
+                mlog_error("T_RECFAST: Unable to open file: %s for reading", fname);
+                ABORT(EXIT_FAILURE);
             }
 
             for (i=(RECFAST_NPTS-1);i>=0;i--) {
@@ -288,8 +435,8 @@ double xion_RECFAST(float z, int flag)
 
             // Read in the data
             if (!(F = fopen(fname, "r"))){
-                mlog("xion_RECFAST: Unable to open file: %s for reading\nAborting\n",MLOG_MESG, fname);
-                return -1;
+                mlog_error("xion_RECFAST: Unable to open file: %s for reading", fname);
+                ABORT(EXIT_FAILURE);
             }
 
             for (i=(RECFAST_NPTS-1);i>=0;i--) {
@@ -356,13 +503,17 @@ double nu_tau_one(double zp, double zpp, double x_e, double fcoll, double HI_fil
         return -1;
     }
 
-    // select solver and allocate memory
-    T = gsl_root_fsolver_brent;
-    s = gsl_root_fsolver_alloc(T); // non-derivative based Brent method
-    if (!s){
-        mlog("Unable to allocate memory in function nu_tau_one\n",MLOG_MESG);
-        return -1;
+    // select solver and allocate memory (on the first call only)
+    xray_workspaces_t* ws = get_xray_workspaces();
+    if (ws->nu_tau_one_solver == NULL) {
+        T = gsl_root_fsolver_brent;
+        ws->nu_tau_one_solver = gsl_root_fsolver_alloc(T); // non-derivative based Brent method
+        if (!ws->nu_tau_one_solver){
+            mlog("Unable to allocate memory in function nu_tau_one\n",MLOG_MESG);
+            return -1;
+        }
     }
+    s = ws->nu_tau_one_solver;
 
     //check if lower bound has null
     if (tauX(HeI_NUIONIZATION, x_e, zp, zpp, fcoll, HI_filling_factor_zp, snap_i) < 1)
@@ -397,12 +548,73 @@ double nu_tau_one(double zp, double zpp, double x_e, double fcoll, double HI_fil
 
     while (status == GSL_CONTINUE && iter < max_iter);
 
-    // deallocate and return
-    gsl_root_fsolver_free (s);
-
     return r;
 }
 
+// The tabulated frequencies run log-uniformly over the bracket searched by `nu_tau_one`
+static double tauX_table_nu(int i_nu)
+{
+    double nu_lo = HeI_NUIONIZATION;
+    double nu_hi = 1e6 * NU_over_EV;
+
+    return nu_lo * pow(nu_hi / nu_lo, (double)i_nu / (double)(run_globals.params.TsTauXTableNNu - 1));
+}
+
+// The accepted error in ln(tauX) at a tabulated root.  tauX falls roughly as
+// nu^-3, so this is comparable to the 2% tolerance in nu of `nu_tau_one`.
+#define TAUX_TABLE_LN_TAU_TOL 0.05
+
+//  The same as nu_tau_one, but found from the tauX table for filtering step R_ct
+//  (see `tabulate_tauX`; zpp must be the zpp_list[R_ct] the table was built with).
+//  The root is interpolated in ln(tauX) vs ln(nu) and then checked with a single
+//  direct evaluation of tauX (as is a root at the lower bound).  If it misses, or
+//  lies outside of the table, we fall back to the full root solve and increment
+//  tauX_table_n_fallbacks.
+static double nu_tau_one_fallback(double zp, double zpp, double x_e, double fcoll, double HI_filling_factor_zp, int snap_i){
+#ifdef USE_OPENMP
+#pragma omp atomic update
+#endif
+    tauX_table_n_fallbacks++;
+
+    return nu_tau_one(zp, zpp, x_e, fcoll, HI_filling_factor_zp, snap_i);
+}
+
+double nu_tau_one_tabulated(int R_ct, double zp, double zpp, double x_e, double fcoll, double HI_filling_factor_zp, int snap_i){
+    int TsNumFilterSteps = run_globals.params.TsNumFilterSteps;
+    int n_nu = run_globals.params.TsTauXTableNNu;
+    int i_nu;
+
+    if (x_e > 0.9999)
+        return nu_tau_one(zp, zpp, x_e, fcoll, HI_filling_factor_zp, snap_i);
+
+    //check if lower bound has null
+    if (tauX_table[R_ct] < 1) {
+        if (tauX(HeI_NUIONIZATION, x_e, zp, zpp, fcoll, HI_filling_factor_zp, snap_i) < 1)
+            return HeI_NUIONIZATION;
+        return nu_tau_one_fallback(zp, zpp, x_e, fcoll, HI_filling_factor_zp, snap_i);
+    }
+
+    for (i_nu = 1; i_nu < n_nu; i_nu++)
+        if (tauX_table[i_nu * TsNumFilterSteps + R_ct] < 1)
+            break;
+
+    double tau_hi = tauX_table[i_nu * TsNumFilterSteps + R_ct];
+    if ((i_nu == n_nu) || !(tau_hi > 0))
+        return nu_tau_one_fallback(zp, zpp, x_e, fcoll, HI_filling_factor_zp, snap_i);
+
+    double ln_nu_lo = log(tauX_table_nu(i_nu - 1));
+    double ln_nu_hi = log(tauX_table_nu(i_nu));
+    double ln_tau_lo = log(tauX_table[(i_nu - 1) * TsNumFilterSteps + R_ct]);
+    double ln_tau_hi = log(tau_hi);
+    double nu = exp(ln_nu_lo - ln_tau_lo * (ln_nu_hi - ln_nu_lo) / (ln_tau_hi - ln_tau_lo));
+
+    double tau = tauX(nu, x_e, zp, zpp, fcoll, HI_filling_factor_zp, snap_i);
+    if (!(tau > 0) || (fabs(log(tau)) > TAUX_TABLE_LN_TAU_TOL))
+        return nu_tau_one_fallback(zp, zpp, x_e, fcoll, HI_filling_factor_zp, snap_i);
+
+    return nu;
+}
+
 
 //  Calculates the optical depth for a photon arriving at z = zp with frequency nu, emitted at z = zpp.
 //  The filling factor of neutral IGM at zp is HI_filling_factor_zp.
@@ -427,34 +639,67 @@ double tauX_integrand(double zhat, void *params){
     sigma_tilde = species_weighted_x_ray_cross_section(nuhat, p->x_e);
     return drpropdz * n * HI_filling_factor_zhat * sigma_tilde;
 }
-double tauX(double nu, double x_e, double zp, double zpp, double fcoll, double HI_filling_factor_zp, int snap_i){
+// The contribution to tauX from photons emitted between z_lo and z_hi
+static double tauX_between(double nu, double x_e, double zp, double z_lo, double z_hi, int snap_i){
     double result, error;
     gsl_function F;
     double rel_tol  = 0.005; //<- relative tolerance
-    gsl_integration_workspace * w
-        = gsl_integration_workspace_alloc (1000);
+    gsl_integration_workspace * w = get_integration_workspace(&get_xray_workspaces()->tauX);
     tauX_params p;
 
     F.function = &tauX_integrand;
     p.nu_0 = nu/(1+zp);
     p.x_e = x_e;
     // effective efficiency for the PS (not ST) mass function; quicker to compute...
-    if (HI_filling_factor_zp > FRACT_FLOAT_ERR){
-        p.ion_eff = run_globals.params.physics.ReionEfficiency;
-    }
-    else
-        p.ion_eff = run_globals.params.physics.ReionEfficiency;
+    p.ion_eff = run_globals.params.physics.ReionEfficiency;
 
     p.snap_i = snap_i;
 
     F.params = &p;
-    gsl_integration_qag (&F, zpp, zp, 0, rel_tol,
-            1000, GSL_INTEG_GAUSS61, w, &result, &error);
-    gsl_integration_workspace_free (w);
+    gsl_integration_qag (&F, z_lo, z_hi, 0, rel_tol,
+            XRAY_WORKSPACE_SIZE, GSL_INTEG_GAUSS61, w, &result, &error);
 
     return result;
 }
 
+double tauX(double nu, double x_e, double zp, double zpp, double fcoll, double HI_filling_factor_zp, int snap_i){
+    return tauX_between(nu, x_e, zp, zpp, zp, snap_i);
+}
+
+//  Fill rows i_nu_start to i_nu_start + n_nu - 1 of tauX_table with tauX for each
+//  tabulated frequency (see `tauX_table_nu`) and each shell in zpp_list (in order
+//  of increasing zpp).  Each row is accumulated shell by shell using a fixed order
+//  Gauss-Legendre rule, which is ample for the narrow shells; the accuracy of the
+//  resulting roots is checked in `nu_tau_one_tabulated`.
+#define TAUX_TABLE_GL_POINTS 8
+void tabulate_tauX(int i_nu_start, int n_nu, double zp, const double* zpp_list, double x_e, int snap_i){
+    int TsNumFilterSteps = run_globals.params.TsNumFilterSteps;
+    gsl_integration_glfixed_table* gl_table = gsl_integration_glfixed_table_alloc(TAUX_TABLE_GL_POINTS);
+    gsl_function F;
+    tauX_params p;
+
+    p.x_e = x_e;
+    p.ion_eff = run_globals.params.physics.ReionEfficiency;
+    p.snap_i = snap_i;
+    F.function = &tauX_integrand;
+    F.params = &p;
+
+    for (int i_nu = i_nu_start; i_nu < i_nu_start + n_nu; i_nu++) {
+        double z_hi = zp;
+        double tau = 0.0;
+
+        p.nu_0 = tauX_table_nu(i_nu)/(1+zp);
+
+        for (int R_ct = 0; R_ct < TsNumFilterSteps; R_ct++) {
+            tau += gsl_integration_glfixed(&F, zpp_list[R_ct], z_hi, gl_table);
+            tauX_table[i_nu * TsNumFilterSteps + R_ct] = tau;
+            z_hi = zpp_list[R_ct];
+        }
+    }
+
+    gsl_integration_glfixed_table_free(gl_table);
+}
+
 // function DTDZ returns the value of dt/dz at the redshift parameter z. //
 double dtdz(float z){
     double x, dxdz, const1, denom, numer, OMl, OMm;
@@ -678,8 +923,8 @@ double spectral_emissivity(double nu_norm, int flag)
 
             // Read in the data
             if (!(F = fopen(fname, "r"))){
-                mlog("spectral_emissivity: Unable to open file: stellar_spectra.dat at %s for reading\nAborting\n",MLOG_MESG, fname);
-                return -1;
+                mlog_error("spectral_emissivity: Unable to open file: stellar_spectra.dat at %s for reading", fname);
+                ABORT(EXIT_FAILURE);
             }
 
             for (i=1;i<NSPEC_MAX;i++) {
@@ -695,9 +940,12 @@ double spectral_emissivity(double nu_norm, int flag)
                 nu_n[i] = (float)(4.0/3.0*(1.0-1.0/pow(n[i], 2.0)));
             }
 
+            // N.B. The Pop2_ion normalisation is applied when the emissivity is
+            // evaluated as the table is read once, but ReionNionPhotPerBary can
+            // change between interactive / MCMC runs.
             for (i=1;i<(NSPEC_MAX-1);i++) {
                 n0_fac = (pow(nu_n[i+1],alpha_S_2[i]+1) - pow(nu_n[i],alpha_S_2[i]+1));
-                N0_2[i] *= (alpha_S_2[i]+1)/n0_fac*Pop2_ion;
+                N0_2[i] *= (alpha_S_2[i]+1)/n0_fac;
                 n0_fac = (pow(nu_n[i+1],alpha_S_3[i]+1) - pow(nu_n[i],alpha_S_3[i]+1));
                 N0_3[i] *= (alpha_S_3[i]+1)/n0_fac*Pop3_ion;
             }
@@ -718,7 +966,7 @@ double spectral_emissivity(double nu_norm, int flag)
         if ((nu_norm >= nu_n[i]) && (nu_norm < nu_n[i+1])) {
             // We are in the correct spectral region
             if (Pop == 2)
-                ans = N0_2[i]*pow(nu_norm,alpha_S_2[i]);
+                ans = N0_2[i]*Pop2_ion*pow(nu_norm,alpha_S_2[i]);
             else
                 ans = N0_3[i]*pow(nu_norm,alpha_S_3[i]);
 
@@ -728,7 +976,7 @@ double spectral_emissivity(double nu_norm, int flag)
 
     i= NSPEC_MAX-1;
     if (Pop == 2)
-        return  N0_2[i]*pow(nu_norm,alpha_S_2[i])/Ly_alpha_HZ;
+        return  N0_2[i]*Pop2_ion*pow(nu_norm,alpha_S_2[i])/Ly_alpha_HZ;
     else
         return N0_3[i]*pow(nu_norm,alpha_S_3[i])/Ly_alpha_HZ;
 }
@@ -820,8 +1068,7 @@ double integrate_over_nu(double zp, double local_x_e, double lower_int_limit, do
     double result, error;
     double rel_tol  = 0.01; //<- relative tolerance
     gsl_function F;
-    gsl_integration_workspace * w
-        = gsl_integration_workspace_alloc (1000);
+    gsl_integration_workspace * w = get_integration_workspace(&get_xray_workspaces()->nu_integral);
 
     int_over_nu_params p;
 
@@ -839,8 +1086,7 @@ double integrate_over_nu(double zp, double local_x_e, double lower_int_limit, do
         F.function = &integrand_in_nu_lya_integral;
     }
 
-    gsl_integration_qag (&F, lower_int_limit, run_globals.params.physics.NuXrayMax*NU_over_EV, 0, rel_tol, 1000, GSL_INTEG_GAUSS61, w, &result, &error);
-    gsl_integration_workspace_free (w);
+    gsl_integration_qag (&F, lower_int_limit, run_globals.params.physics.NuXrayMax*NU_over_EV, 0, rel_tol, XRAY_WORKSPACE_SIZE, GSL_INTEG_GAUSS61, w, &result, &error);
 
     // if it is the Lya integral, add prefactor
     if (FLAG == 2)
@@ -849,16 +1095,25 @@ double integrate_over_nu(double zp, double local_x_e, double lower_int_limit, do
     return result;
 }
 
-// Call once to read in data files and set up arrays for interpolation.
-// All data files should be in a local subdirectory "x_int_tables/"; if moved, change input_base
-// below to new location.
-void initialize_interp_arrays()
+// Construct the name of the x_int text table for ionized fraction `n_ion`.
+static void x_int_table_fname(int n_ion, char* input_file_name)
+{
+    char input_base[] = "x_int_tables/";
+    char input_tail[100] = ".dat";
+
+    if (x_int_XHII[n_ion] < 0.3) {
+        sprintf(input_file_name,"%s/%slog_xi_%1.1f%s",run_globals.params.TablesForXHeatingDir,input_base,log10(x_int_XHII[n_ion]),input_tail);
+    } else {
+        sprintf(input_file_name,"%s/%sxi_%1.3f%s",run_globals.params.TablesForXHeatingDir,input_base,x_int_XHII[n_ion],input_tail);
+    }
+}
+
+// Parse the x_int text tables (one per ionized fraction) on this rank.
+static void read_interp_arrays_text()
 {
     FILE *input_file;
     char input_file_name[500];
 
-    char input_base[] = "x_int_tables/";
-    char input_tail[100] = ".dat";
     char mode[10] = "r";
 
     float xHI,xHeI,xHeII,z,T;
@@ -868,6 +1123,172 @@ void initialize_interp_arrays()
     int i;
     int n_ion;
 
+    for (n_ion=0;n_ion<x_int_NXHII;n_ion++) {
+
+        x_int_table_fname(n_ion, input_file_name);
+
+        input_file = fopen(input_file_name, mode);
+
+        if (input_file == NULL) {
+            mlog_error("Can't open input file %s!", input_file_name);
+            ABORT(EXIT_FAILURE);
+        }
+
+        // Read in first line
+        for (i=1;i<=5;i++) {
+            fscanf(input_file,"%s", label);
+        }
+
+        // Read in second line (ionized fractions info)
+        fscanf(input_file,"%g %g %g %g %g", &xHI, &xHeI, &xHeII, &z, &T);
+
+        // Read in column headings
+        for (i=1;i<=11;i++) {
+            fscanf(input_file,"%s", label);
+        }
+
+        // Read in data table
+        for (i=0;i<x_int_NENERGY;i++) {
+            fscanf(input_file,"%g %g %g %g %g %g %g %g %g",
+                    &x_int_Energy[i],
+                    &trash,
+                    &x_int_fheat[n_ion][i],
+                    &trash,
+                    &x_int_n_Lya[n_ion][i],
+                    &x_int_nion_HI[n_ion][i],
+                    &x_int_nion_HeI[n_ion][i],
+                    &x_int_nion_HeII[n_ion][i],
+                    &trash);
+        }
+
+        fclose(input_file);
+    }
+}
+
+// Fill `stamp` with the size and modification time of each x_int text table.
+// The cache is only used if these match the values stored when it was
+// written, so that edited or replaced tables are never shadowed by a stale
+// cache.  Returns false if any of the tables can't be stat'd.
+static bool x_int_tables_stamp(long long stamp[x_int_NXHII][2])
+{
+    char input_file_name[500];
+    struct stat st;
+
+    for (int n_ion = 0; n_ion < x_int_NXHII; n_ion++) {
+        x_int_table_fname(n_ion, input_file_name);
+        if (stat(input_file_name, &st) != 0)
+            return false;
+        stamp[n_ion][0] = (long long)st.st_size;
+        stamp[n_ion][1] = (long long)st.st_mtime;
+    }
+
+    return true;
+}
+
+// Read the x_int tables from a binary cache written by `write_interp_arrays_cache`.
+// Returns false if there is no usable cache.
+static bool read_interp_arrays_cache(const char* fname)
+{
+    if (access(fname, R_OK) != 0)
+        return false;
+
+    long long stamp[x_int_NXHII][2];
+    if (!x_int_tables_stamp(stamp))
+        return false;
+
+    hid_t fd = H5Fopen(fname, H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (fd < 0)
+        return false;
+
+    // Check the cache was written from the current tables...
+    long long cached_stamp[x_int_NXHII][2];
+    hsize_t dims[2] = { 0, 0 };
+    bool ok = (H5LTget_dataset_info(fd, "source_stamp", dims, NULL, NULL) >= 0)
+        && (dims[0] == x_int_NXHII) && (dims[1] == 2)
+        && (H5LTread_dataset(fd, "source_stamp", H5T_NATIVE_LLONG, cached_stamp) >= 0)
+        && (memcmp(stamp, cached_stamp, sizeof(stamp)) == 0);
+
+    if (!ok)
+        mlog("X-ray heating table cache %s does not match the tables in %s/x_int_tables; ignoring it", MLOG_MESG, fname,
+            run_globals.params.TablesForXHeatingDir);
+
+    // ...and that the tables have the shape we expect before reading them
+    ok = ok && (H5LTget_dataset_info(fd, "fheat", dims, NULL, NULL) >= 0)
+        && (dims[0] == x_int_NXHII) && (dims[1] == x_int_NENERGY);
+
+    ok = ok && (H5LTread_dataset_float(fd, "Energy", x_int_Energy) >= 0)
+        && (H5LTread_dataset_float(fd, "fheat", (float*)x_int_fheat) >= 0)
+        && (H5LTread_dataset_float(fd, "n_Lya", (float*)x_int_n_Lya) >= 0)
+        && (H5LTread_dataset_float(fd, "nion_HI", (float*)x_int_nion_HI) >= 0)
+        && (H5LTread_dataset_float(fd, "nion_HeI", (float*)x_int_nion_HeI) >= 0)
+        && (H5LTread_dataset_float(fd, "nion_HeII", (float*)x_int_nion_HeII) >= 0);
+
+    H5Fclose(fd);
+
+    return ok;
+}
+
+// Write the parsed x_int tables to `fname`, stamped with the state of the text
+// tables they came from.  The cache lives in the (shared) tables directory, so
+// it is written to a temporary file first and then renamed into place.  That
+// way other runs only ever see either no cache or a complete one.
+static void write_interp_arrays_cache(const char* fname)
+{
+    hsize_t dims_energy[1] = { x_int_NENERGY };
+    hsize_t dims[2] = { x_int_NXHII, x_int_NENERGY };
+    hsize_t dims_stamp[2] = { x_int_NXHII, 2 };
+
+    long long stamp[x_int_NXHII][2];
+    if (!x_int_tables_stamp(stamp))
+        return;
+
+    char tmp_fname[STRLEN + 64];
+    char hostname[64] = "";
+    gethostname(hostname, sizeof(hostname) - 1);
+    sprintf(tmp_fname, "%s.tmp.%s.%d", fname, hostname, (int)getpid());
+
+    // The tables directory may well be read-only, in which case we just carry on without a cache
+    herr_t (*old_func)(long, void*);
+    void *old_client_data;
+    hid_t error_stack = 0;
+    H5Eget_auto(error_stack, &old_func, &old_client_data);
+    H5Eset_auto(error_stack, NULL, NULL);
+
+    hid_t fd = H5Fcreate(tmp_fname, H5F_ACC_EXCL, H5P_DEFAULT, H5P_DEFAULT);
+
+    H5Eset_auto(error_stack, old_func, old_client_data);
+
+    if (fd < 0) {
+        mlog("Unable to create X-ray heating table cache %s", MLOG_MESG, tmp_fname);
+        return;
+    }
+
+    bool ok = (H5LTmake_dataset(fd, "source_stamp", 2, dims_stamp, H5T_NATIVE_LLONG, stamp) >= 0)
+        && (H5LTmake_dataset_float(fd, "Energy", 1, dims_energy, x_int_Energy) >= 0)
+        && (H5LTmake_dataset_float(fd, "fheat", 2, dims, (float*)x_int_fheat) >= 0)
+        && (H5LTmake_dataset_float(fd, "n_Lya", 2, dims, (float*)x_int_n_Lya) >= 0)
+        && (H5LTmake_dataset_float(fd, "nion_HI", 2, dims, (float*)x_int_nion_HI) >= 0)
+        && (H5LTmake_dataset_float(fd, "nion_HeI", 2, dims, (float*)x_int_nion_HeI) >= 0)
+        && (H5LTmake_dataset_float(fd, "nion_HeII", 2, dims, (float*)x_int_nion_HeII) >= 0);
+
+    ok = (H5Fclose(fd) >= 0) && ok;
+
+    if (!ok || (rename(tmp_fname, fname) != 0)) {
+        mlog("Unable to write X-ray heating table cache %s", MLOG_MESG, fname);
+        remove(tmp_fname);
+        return;
+    }
+
+    mlog("Wrote X-ray heating table cache %s", MLOG_MESG, fname);
+}
+
+// Call once to read in data files and set up arrays for interpolation.
+// All data files should be in the subdirectory "x_int_tables/" of
+// TablesForXHeatingDir.  If Flag_CacheXHeatingTables is set, the parsed
+// tables are also stored in TablesForXHeatingDir/x_int_tables.hdf5 and read
+// from there by later runs (for as long as the text tables are unchanged).
+void initialize_interp_arrays()
+{
     // Initialize array of ionized fractions
     x_int_XHII[0] = 1.0e-4;
     x_int_XHII[1] = 2.318e-4;
@@ -885,51 +1306,15 @@ void initialize_interp_arrays()
     x_int_XHII[13] = 0.999;
 
     if (run_globals.mpi_rank == 0) {
-
-        for (n_ion=0;n_ion<x_int_NXHII;n_ion++) {
-
-            // Construct filename
-            if (x_int_XHII[n_ion] < 0.3) {
-                sprintf(input_file_name,"%s/%slog_xi_%1.1f%s",run_globals.params.TablesForXHeatingDir,input_base,log10(x_int_XHII[n_ion]),input_tail);
-            } else {
-                sprintf(input_file_name,"%s/%sxi_%1.3f%s",run_globals.params.TablesForXHeatingDir,input_base,x_int_XHII[n_ion],input_tail);
-            }
-
-            input_file = fopen(input_file_name, mode);
-
-            if (input_file == NULL) {
-                mlog("Can't open input file %s!\n",MLOG_MESG, input_file_name);
-                exit(1);
-            }
-
-            // Read in first line
-            for (i=1;i<=5;i++) {
-                fscanf(input_file,"%s", label);
-            }
-
-            // Read in second line (ionized fractions info)
-            fscanf(input_file,"%g %g %g %g %g", &xHI, &xHeI, &xHeII, &z, &T);
-
-            // Read in column headings
-            for (i=1;i<=11;i++) {
-                fscanf(input_file,"%s", label);
-            }
-
-            // Read in data table
-            for (i=0;i<x_int_NENERGY;i++) {
-                fscanf(input_file,"%g %g %g %g %g %g %g %g %g",
-                        &x_int_Energy[i],
-                        &trash,
-                        &x_int_fheat[n_ion][i],
-                        &trash,
-                        &x_int_n_Lya[n_ion][i],
-                        &x_int_nion_HI[n_ion][i],
-                        &x_int_nion_HeI[n_ion][i],
-                        &x_int_nion_HeII[n_ion][i],
-                        &trash);
-            }
-
-            fclose(input_file);
+        char cache_fname[STRLEN + 32];
+        sprintf(cache_fname, "%s/x_int_tables.hdf5", run_globals.params.TablesForXHeatingDir);
+
+        if (run_globals.params.Flag_CacheXHeatingTables && read_interp_arrays_cache(cache_fname)) {
+            mlog("Read X-ray heating tables from cache %s", MLOG_MESG, cache_fname);
+        } else {
+            read_interp_arrays_text();
+            if (run_globals.params.Flag_CacheXHeatingTables)
+                write_interp_arrays_cache(cache_fname);
         }
     }
 
@@ -1260,9 +1645,38 @@ int locate_xHII_index(float xHII_call)
     return m_xHII_low;
 }
 
+// Everything in the z'' integrand of `evolveInt` other than the smoothed SFR
+// and the frequency integrals depends only on the redshift, so is evaluated
+// once per snapshot here rather than for every cell.
+// N.B. Must be called after zpp_edge, sum_lyn and dt_dzpp have been set.
+void init_zpp_weights(float zp)
+{
+    double zpp, dzpp;
+
+    for (int zpp_ct = 0; zpp_ct < run_globals.params.TsNumFilterSteps; zpp_ct++) {
+        // set redshift of half annulus; dz'' is negative since we flipped limits of integral
+        if (zpp_ct == 0) {
+            zpp = (zpp_edge[0] + zp) * 0.5;
+            dzpp = zp - zpp_edge[0];
+        } else {
+            zpp = (zpp_edge[zpp_ct] + zpp_edge[zpp_ct - 1]) * 0.5;
+            dzpp = zpp_edge[zpp_ct - 1] - zpp_edge[zpp_ct];
+        }
+
+        // Use this when using the SFR provided by Meraxes
+        // Units should be M_solar/s. Factor of (dt_dzp * dzpp) converts from per s to per z'
+        zpp_weight_GAL[zpp_ct] = dt_dzpp * dzpp * pow(1 + zpp, -run_globals.params.physics.SpecIndexXrayGal);
+        if (run_globals.params.Flag_SeparateQSOXrays)
+            zpp_weight_QSO[zpp_ct] = dt_dzpp * dzpp * pow(1 + zpp, -run_globals.params.physics.SpecIndexXrayQSO);
+
+        lya_weight[zpp_ct] = pow(1 + zp, 2) * (1 + zpp) * sum_lyn[zpp_ct] * dt_dzpp * dzpp;
+    }
+}
+
 // ********************************************************************
 // ************************** IGM Evolution ***************************
 //  This function creates the d/dz' integrands
+//  N.B. `init_zpp_weights` must have been called for this zp
 // *********************************************************************
 void evolveInt(float zp, float curr_delNL0, const double SFR_GAL[], const double SFR_QSO[],
         const double freq_int_heat_GAL[], const double freq_int_ion_GAL[], const double freq_int_lya_GAL[],
@@ -1271,9 +1685,8 @@ void evolveInt(float zp, float curr_delNL0, const double SFR_GAL[], const double
 
     double  dadia_dzp, dcomp_dzp, dxheat_dt_GAL, dxion_source_dt_GAL, dxion_sink_dt;
     double dxheat_dt_QSO, dxion_source_dt_QSO, dxlya_dt_QSO, dstarlya_dt_QSO;
-    double zpp, dzpp;
-    int zpp_ct;
-    double T, x_e, zpp_integrand_GAL, zpp_integrand_QSO;
+    int TsNumFilterSteps = run_globals.params.TsNumFilterSteps;
+    double T, x_e;
     double dxe_dzp, n_b, dspec_dzp, dxheat_dzp, dxlya_dt_GAL, dstarlya_dt_GAL;
 
     x_e = y[0];
@@ -1293,50 +1706,29 @@ void evolveInt(float zp, float curr_delNL0, const double SFR_GAL[], const double
     dstarlya_dt_QSO = 0;
 
     if (!NO_LIGHT){
-        for (zpp_ct = 0; zpp_ct < run_globals.params.TsNumFilterSteps; zpp_ct++){
-            // set redshift of half annulus; dz'' is negative since we flipped limits of integral
-            if (zpp_ct==0){
-                zpp = (zpp_edge[0]+zp)*0.5;
-                dzpp = zp - zpp_edge[0];
-            }
-            else{
-                zpp = (zpp_edge[zpp_ct]+zpp_edge[zpp_ct-1])*0.5;
-                dzpp = zpp_edge[zpp_ct-1] - zpp_edge[zpp_ct];
-            }
-
-            // Use this when using the SFR provided by Meraxes
-            // Units should be M_solar/s. Factor of (dt_dzp * dzpp) converts from per s to per z'
-            zpp_integrand_GAL = SFR_GAL[zpp_ct] * pow(1+zpp, -run_globals.params.physics.SpecIndexXrayGal);
-            if(run_globals.params.Flag_SeparateQSOXrays) {
-                zpp_integrand_QSO = SFR_QSO[zpp_ct] * pow(1+zpp, -run_globals.params.physics.SpecIndexXrayQSO);
-            }
-
-            if(run_globals.params.Flag_SeparateQSOXrays) {
-
-                dxheat_dt_GAL += dt_dzpp * dzpp * zpp_integrand_GAL * freq_int_heat_GAL[zpp_ct];
-                dxheat_dt_QSO += dt_dzpp * dzpp * zpp_integrand_QSO * freq_int_heat_QSO[zpp_ct];
-
-                dxion_source_dt_GAL += dt_dzpp * dzpp * zpp_integrand_GAL * freq_int_ion_GAL[zpp_ct];
-                dxion_source_dt_QSO += dt_dzpp * dzpp * zpp_integrand_QSO * freq_int_ion_QSO[zpp_ct];
-
-                dxlya_dt_GAL += dt_dzpp * dzpp * zpp_integrand_GAL * freq_int_lya_GAL[zpp_ct];
-                dxlya_dt_QSO += dt_dzpp * dzpp * zpp_integrand_QSO * freq_int_lya_QSO[zpp_ct];
-
-                // Use this when using the SFR provided by Meraxes
-                // Units should be M_solar/s. Factor of (dt_dzp * dzpp) converts from per s to per z'
-                dstarlya_dt_GAL += SFR_GAL[zpp_ct] * pow(1+zp,2)*(1+zpp) * sum_lyn[zpp_ct] * dt_dzpp * dzpp;
-                dstarlya_dt_QSO += SFR_QSO[zpp_ct] * pow(1+zp,2)*(1+zpp) * sum_lyn[zpp_ct] * dt_dzpp * dzpp;
+#ifdef USE_OPENMP
+#pragma omp simd reduction(+ : dxheat_dt_GAL, dxion_source_dt_GAL, dxlya_dt_GAL, dstarlya_dt_GAL)
+#endif
+        for (int zpp_ct = 0; zpp_ct < TsNumFilterSteps; zpp_ct++){
+            double zpp_integrand_GAL = zpp_weight_GAL[zpp_ct] * SFR_GAL[zpp_ct];
 
-            }
-            else {
-                dxheat_dt_GAL += dt_dzpp * dzpp * zpp_integrand_GAL * freq_int_heat_GAL[zpp_ct];
-                dxion_source_dt_GAL += dt_dzpp * dzpp * zpp_integrand_GAL * freq_int_ion_GAL[zpp_ct];
-                dxlya_dt_GAL += dt_dzpp * dzpp * zpp_integrand_GAL * freq_int_lya_GAL[zpp_ct];
+            dxheat_dt_GAL += zpp_integrand_GAL * freq_int_heat_GAL[zpp_ct];
+            dxion_source_dt_GAL += zpp_integrand_GAL * freq_int_ion_GAL[zpp_ct];
+            dxlya_dt_GAL += zpp_integrand_GAL * freq_int_lya_GAL[zpp_ct];
+            dstarlya_dt_GAL += lya_weight[zpp_ct] * SFR_GAL[zpp_ct];
+        }
 
-                // Use this when using the SFR provided by Meraxes
-                // Units should be M_solar/s. Factor of (dt_dzp * dzpp) converts from per s to per z'
-                dstarlya_dt_GAL += SFR_GAL[zpp_ct] * pow(1+zp,2)*(1+zpp) * sum_lyn[zpp_ct] * dt_dzpp * dzpp;
+        if(run_globals.params.Flag_SeparateQSOXrays) {
+#ifdef USE_OPENMP
+#pragma omp simd reduction(+ : dxheat_dt_QSO, dxion_source_dt_QSO, dxlya_dt_QSO, dstarlya_dt_QSO)
+#endif
+            for (int zpp_ct = 0; zpp_ct < TsNumFilterSteps; zpp_ct++){
+                double zpp_integrand_QSO = zpp_weight_QSO[zpp_ct] * SFR_QSO[zpp_ct];
 
+                dxheat_dt_QSO += zpp_integrand_QSO * freq_int_heat_QSO[zpp_ct];
+                dxion_source_dt_QSO += zpp_integrand_QSO * freq_int_ion_QSO[zpp_ct];
+                dxlya_dt_QSO += zpp_integrand_QSO * freq_int_lya_QSO[zpp_ct];
+                dstarlya_dt_QSO += lya_weight[zpp_ct] * SFR_QSO[zpp_ct];
             }
         }
 
@@ -1626,7 +2018,7 @@ double kappa_10(double TK, int flag)
         ans = log(exp(kap[KAPPA_10_NPTS-1])*pow(TK/exp(tkin[KAPPA_10_NPTS-1]),0.381));
     } else { // * Do spline * //
         TK = log(TK);
-        ans = gsl_spline_eval (spline, TK, acc);
+        ans = gsl_spline_eval (spline, TK, KAPPA_ACCEL(acc));
     }
     return exp(ans);
 }
@@ -1655,8 +2047,8 @@ double kappa_10_elec(double T, int flag)
 
             // Read in the data
             if (!(F = fopen(fname, "r"))){
-                mlog("Unable to open the kappa_10^eH file at %s\nAborting\n",MLOG_MESG, fname);
-                return 0;
+                mlog_error("Unable to open the kappa_10^eH file at %s", fname);
+                ABORT(EXIT_FAILURE);
             }
 
             for (i=0;i<KAPPA_10_elec_NPTS;i++) {
@@ -1664,6 +2056,7 @@ double kappa_10_elec(double T, int flag)
                 TK[i] = curr_TK;
                 kappa[i] = curr_kappa;
             }
+            fclose(F);
 
             for (i=0;i<KAPPA_10_elec_NPTS;i++) {
                 TK[i] = log(TK[i]);
@@ -1701,7 +2094,7 @@ double kappa_10_elec(double T, int flag)
              (T-TK[KAPPA_10_elec_NPTS-1]));
     }
     else { // * Do spline * //
-        ans = gsl_spline_eval (spline, T, acc);
+        ans = gsl_spline_eval (spline, T, KAPPA_ACCEL(acc));
     }
     return exp(ans);
 }
@@ -1730,8 +2123,8 @@ double kappa_10_pH(double T, int flag)
             sprintf(fname, "%s/kappa_pH_table.dat", run_globals.params.TablesForXHeatingDir);
 
             if (!(F=fopen(fname, "r"))){
-                mlog("Unable to open the kappa_10^pH file at %s\nAborting\n", MLOG_MESG, fname);
-                return 0;
+                mlog_error("Unable to open the kappa_10^pH file at %s", fname);
+                ABORT(EXIT_FAILURE);
             }
 
             for (i=0;i<KAPPA_10_pH_NPTS;i++) {
@@ -1776,7 +2169,7 @@ double kappa_10_pH(double T, int flag)
              (TK[KAPPA_10_pH_NPTS-1] - TK[KAPPA_10_pH_NPTS-2]) *
              (T-TK[KAPPA_10_pH_NPTS-1]));
     } else { // * Do spline * //
-        ans = gsl_spline_eval (spline, T, acc);
+        ans = gsl_spline_eval (spline, T, KAPPA_ACCEL(acc));
     }
     ans = exp(ans);
     return ans;
@@ -14,6 +14,10 @@ void cleanup()
         free(run_globals.baryon_frac_modifier);
 
     free_halo_storage();
+    free_galaxy_pool();
+
+    if (run_globals.params.physics.SfPrescription == 2)
+        free_pressure_dependent_star_formation();
 
 #ifdef CALC_MAGS
     cleanup_mags();
@@ -25,6 +29,9 @@ void cleanup()
     if (run_globals.params.Flag_PatchyReion) {
         free_reionization_grids();
         fftwf_mpi_cleanup();
+#ifdef USE_FFTW_THREADS
+        fftwf_cleanup_threads();
+#endif
     }
 
     if (!run_globals.params.FlagMCMC) {
@@ -49,6 +56,7 @@ void cleanup()
 
     gsl_rng_free(run_globals.random_generator);
 
+    free(run_globals.SnapshotConsts);
     free(run_globals.ListOutputSnaps);
     free(run_globals.LTTime);
     free(run_globals.ZZ);
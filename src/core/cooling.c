@@ -40,6 +40,22 @@ static char group_name[N_METALLICITIES][6] = {
 
 static double cooling_rate[N_METALLICITIES][N_TEMPS];
 
+// The tabulated log cooling rates are resampled onto a uniform (logT, logZ)
+// grid so that lookups need no search over metallicities.  The temperature
+// nodes are the tabulated ones and the metallicity spacing divides the spacing
+// of the tabulated metallicities, so bilinearly interpolating the log rates on
+// this grid reproduces the original interpolation (to rounding).  The rates are
+// stored as natural logs so that each lookup needs an exp() rather than a pow().
+#define N_GRID_METALLICITIES 111 // 0.05 dex spacing between metallicities[0] and metallicities[N_METALLICITIES-1]
+
+static double ln_cooling_rate_grid[N_TEMPS][N_GRID_METALLICITIES];
+static double grid_dlogT;
+static double grid_dlogZ;
+static double grid_inv_dlogT;
+static double grid_inv_dlogZ;
+
+static void resample_cooling_rates();
+
 void read_cooling_functions()
 {
     if (run_globals.mpi_rank == 0) {
@@ -64,6 +80,8 @@ void read_cooling_functions()
     // add solar metallicity to all metallicity values
     for (int i_m = 0; i_m < N_METALLICITIES; i_m++)
         metallicities[i_m] += log10(0.02);
+
+    resample_cooling_rates();
 }
 
 static double interpolate_temp_dependant_cooling_rate(int i_m, double logTemp)
@@ -96,7 +114,7 @@ static double interpolate_temp_dependant_cooling_rate(int i_m, double logTemp)
     return rate;
 }
 
-double interpolate_cooling_rate(double logTemp, double logZ)
+static double interpolate_log_cooling_rate(double logTemp, double logZ)
 {
     int i_m;
     double rate_below, rate_above, rate;
@@ -119,5 +137,56 @@ double interpolate_cooling_rate(double logTemp, double logZ)
     // Finally, linearly interpolate the cooling rates
     rate = rate_below + (rate_above - rate_below) / (metallicities[i_m + 1] - metallicities[i_m]) * (logZ - metallicities[i_m]);
 
-    return pow(10, rate);
+    return rate;
+}
+
+static void resample_cooling_rates()
+{
+    grid_dlogT = (MAX_TEMP - MIN_TEMP) / (double)(N_TEMPS - 1);
+    grid_dlogZ = (metallicities[N_METALLICITIES - 1] - metallicities[0]) / (double)(N_GRID_METALLICITIES - 1);
+    grid_inv_dlogT = 1.0 / grid_dlogT;
+    grid_inv_dlogZ = 1.0 / grid_dlogZ;
+
+    for (int i_t = 0; i_t < N_TEMPS; i_t++) {
+        double logTemp = MIN_TEMP + grid_dlogT * i_t;
+        for (int i_z = 0; i_z < N_GRID_METALLICITIES; i_z++) {
+            double logZ = metallicities[0] + grid_dlogZ * i_z;
+            ln_cooling_rate_grid[i_t][i_z] = M_LN10 * interpolate_log_cooling_rate(logTemp, logZ);
+        }
+    }
+}
+
+double interpolate_cooling_rate(double logTemp, double logZ)
+{
+    // First deal with boundary conditions
+    if (logTemp < MIN_TEMP)
+        return 1.0e-27;
+
+    // Above the table we extrapolate in log space as before (this is very rare)
+    if (logTemp > MAX_TEMP)
+        return pow(10, interpolate_log_cooling_rate(logTemp, logZ));
+
+    if (logZ < metallicities[0])
+        logZ = metallicities[0];
+    if (logZ > metallicities[N_METALLICITIES - 1])
+        logZ = metallicities[N_METALLICITIES - 1];
+
+    // Find the grid cell containing our values
+    double x_t = (logTemp - MIN_TEMP) * grid_inv_dlogT;
+    double x_z = (logZ - metallicities[0]) * grid_inv_dlogZ;
+    int i_t = (int)x_t;
+    int i_z = (int)x_z;
+    if (i_t > N_TEMPS - 2)
+        i_t = N_TEMPS - 2;
+    if (i_z > N_GRID_METALLICITIES - 2)
+        i_z = N_GRID_METALLICITIES - 2;
+    double f_t = x_t - i_t;
+    double f_z = x_z - i_z;
+
+    // Bilinearly interpolate the log cooling rate
+    const double* rate_below = ln_cooling_rate_grid[i_t];
+    const double* rate_above = ln_cooling_rate_grid[i_t + 1];
+
+    return exp((1.0 - f_t) * ((1.0 - f_z) * rate_below[i_z] + f_z * rate_below[i_z + 1])
+        + f_t * ((1.0 - f_z) * rate_above[i_z] + f_z * rate_above[i_z + 1]));
 }
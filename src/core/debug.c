@@ -62,27 +62,27 @@ static void find_missing_gals(fof_group_t* fof_group, int NFof, int flag)
 
         // Loop through each FOF halo and mark off each galaxy
         for (int i_fof = 0; i_fof < NFof; i_fof++) {
-            halo = fof_group[i_fof].FirstHalo;
+            halo = fof_first_halo(&(fof_group[i_fof]));
             while (halo != NULL) {
                 gal = halo->Galaxy;
                 while (gal != NULL) {
                     gal_found[gal->output_index] = true;
                     gal = gal->NextGalInHalo;
                 }
-                halo = halo->NextHaloInFOFGroup;
+                halo = next_halo_in_fof_group(halo);
             }
         }
     } else if (flag == 1) {
         // Count the number of galaxies
         for (int i_fof = 0; i_fof < NFof; i_fof++) {
-            halo = fof_group[i_fof].FirstHalo;
+            halo = fof_first_halo(&(fof_group[i_fof]));
             while (halo != NULL) {
                 gal = halo->Galaxy;
                 while (gal != NULL) {
                     gal->output_index = counter++;
                     gal = gal->NextGalInHalo;
                 }
-                halo = halo->NextHaloInFOFGroup;
+                halo = next_halo_in_fof_group(halo);
             }
         }
 
@@ -124,7 +124,7 @@ static void find_missing_gals(fof_group_t* fof_group, int NFof, int flag)
     mlog("I find %d gals with ghost_flag=true", MLOG_MESG, counter);
     counter = 0;
     for (int i_fof = 0; i_fof < NFof; i_fof++) {
-        halo = fof_group[i_fof].FirstHalo;
+        halo = fof_first_halo(&(fof_group[i_fof]));
         while (halo != NULL) {
             gal = halo->Galaxy;
             while (gal != NULL) {
@@ -132,7 +132,7 @@ static void find_missing_gals(fof_group_t* fof_group, int NFof, int flag)
                     counter++;
                 gal = gal->NextGalInHalo;
             }
-            halo = halo->NextHaloInFOFGroup;
+            halo = next_halo_in_fof_group(halo);
         }
     }
     mlog("I find %d gals with ghost_flag=true (FOF traversal)", MLOG_MESG, counter);
@@ -153,7 +153,7 @@ static void find_missing_gals(fof_group_t* fof_group, int NFof, int flag)
         for (int ii = 0; ii < master_counter; ii++)
             if (!gal_found[ii])
                 for (int i_fof = 0; i_fof < NFof; i_fof++) {
-                    halo = fof_group[i_fof].FirstHalo;
+                    halo = fof_first_halo(&(fof_group[i_fof]));
                     while (halo != NULL) {
                         gal = halo->Galaxy;
                         while (gal != NULL) {
@@ -161,7 +161,7 @@ static void find_missing_gals(fof_group_t* fof_group, int NFof, int flag)
                                 missing_pointers[counter++] = gal;
                             gal = gal->NextGalInHalo;
                         }
-                        halo = halo->NextHaloInFOFGroup;
+                        halo = next_halo_in_fof_group(halo);
                     }
                 }
     }
@@ -213,7 +213,7 @@ void check_counts(fof_group_t* fof_group, int NGal, int NFof)
         int ii;
         for (int i_fof = 0; i_fof < NFof; i_fof++) {
             int jj = 0;
-            halo = fof_group[i_fof].FirstHalo;
+            halo = fof_first_halo(&(fof_group[i_fof]));
             while (halo != NULL) {
                 gal = halo->Galaxy;
                 if (gal != NULL)
@@ -226,7 +226,7 @@ void check_counts(fof_group_t* fof_group, int NGal, int NFof)
                     if (ii > 1e4)
                         ABORT(EXIT_FAILURE);
                 }
-                halo = halo->NextHaloInFOFGroup;
+                halo = next_halo_in_fof_group(halo);
                 halo_counter++;
                 jj++;
                 if (jj > 1e5)
@@ -287,24 +287,16 @@ void check_pointers(halo_t* halos, fof_group_t* fof_groups, trees_info_t* trees_
     }
 
     for (int ii = 0; ii < n_halos; ii++) {
-        fof_group_t* fof_group = halos[ii].FOFGroup;
-        // mlog("%ld < %ld\n", MLOG_MESG, fof_group-fof_groups, n_fof_groups);
-        assert((fof_group - fof_groups) < (long)n_fof_groups);
-        halo = halos[ii].NextHaloInFOFGroup;
-        if (halo != NULL)
-            // mlog("%llu < %llu", MLOG_MESG, halo-halos, (size_t)n_halos);
-            assert((halo - halos) < (long)n_halos);
+        assert((halos[ii].FOFGroup > -1) && (halos[ii].FOFGroup < n_fof_groups));
+        assert(halos[ii].NextHaloInFOFGroup < n_halos);
         gal = halos[ii].Galaxy;
         if (gal != NULL)
             gal_deref = *gal;
     }
 
     for (int ii = 0; ii < n_fof_groups; ii++) {
-        halo = fof_groups[ii].FirstHalo;
-        assert((halo - halos) < (long)n_halos);
-        halo = fof_groups[ii].FirstOccupiedHalo;
-        if (halo != NULL)
-            assert((halo - halos) < (long)n_halos);
+        assert((fof_groups[ii].FirstHalo > -1) && (fof_groups[ii].FirstHalo < n_halos));
+        assert(fof_groups[ii].FirstOccupiedHalo < n_halos);
     }
 }
 
@@ -67,6 +67,10 @@ void dracarys()
     timer_info timer;
     timer_start(&timer);
 
+    // The parameters may have changed since the last run (interactive and MCMC
+    // modes), so recalculate the redshift dependent constants
+    set_snapshot_consts();
+
     // Loop through each snapshot
     for (int snapshot = 0; snapshot <= last_snap; snapshot++) {
         int* index_lookup = NULL;
@@ -81,6 +85,7 @@ void dracarys()
 
         // Reset book keeping counters
         kill_counter = 0;
+        run_globals.NGalaxyListPasses = 0;
 
         // Read in the halos for this snapshot
         if (run_globals.params.FlagInteractive || run_globals.params.FlagMCMC)
@@ -94,6 +99,8 @@ void dracarys()
         halo = snapshot_halo[i_snap];
         fof_group = snapshot_fof_group[i_snap];
         index_lookup = snapshot_index_lookup[i_snap];
+        run_globals.CurrentHalo = halo;
+        run_globals.CurrentFOFGroup = fof_group;
 
         mlog("Processing snapshot %d (z = %.2f)...", MLOG_OPEN | MLOG_TIMERSTART, snapshot, run_globals.ZZ[snapshot]);
 
@@ -101,10 +108,14 @@ void dracarys()
         if ((run_globals.params.Flag_PatchyReion) && (run_globals.params.ReionUVBFlag))
             calculate_Mvir_crit(run_globals.ZZ[snapshot]);
 
-        // Reset the halo pointers and ghost flags for all galaxies and decrement
-        // the snapskip counter
+        // Update the LastIdentSnap values for galaxies which were not ghosts at
+        // the previous snapshot, then reset the halo pointers and ghost flags
+        // for all galaxies and decrement the snapskip counter
         gal = run_globals.FirstGal;
+        run_globals.NGalaxyListPasses++;
         while (gal != NULL) {
+            if ((snapshot > 0) && (!gal->ghost_flag))
+                gal->LastIdentSnap = snapshot - 1;
             gal->Halo = NULL;
             gal->ghost_flag = false;
             gal->SnapSkipCounter--;
@@ -115,6 +126,7 @@ void dracarys()
         // Loop through each galaxy we already have
         gal = run_globals.FirstGal;
         prev_gal = NULL;
+        run_globals.NGalaxyListPasses++;
         while (gal != NULL) {
             // Get the index of this galaxies descendent halo (which will be the one
             // which exists at this snapshot unless the halo has skipped a snap).
@@ -174,24 +186,6 @@ void dracarys()
                 gal = run_globals.FirstGal;
         }
 
-        // Do one more pass to make sure that we have killed all galaxies which we
-        // should have (i.e. satellites in strayed halos etc.)
-        prev_gal = NULL;
-        next_gal = NULL;
-        gal = run_globals.FirstGal;
-        while (gal != NULL) {
-            if (gal->HaloDescIndex < 0) {
-                next_gal = gal->Next;
-                kill_galaxy(gal, prev_gal, &NGal, &kill_counter);
-                gal = prev_gal;
-            }
-            prev_gal = gal;
-            if (gal != NULL)
-                gal = gal->Next;
-            else
-                gal = next_gal;
-        }
-
         // Store the number of ghost galaxies present at this snapshot
         run_globals.NGhosts = ghost_counter;
 
@@ -207,58 +201,68 @@ void dracarys()
         // this for loop must appear before the follwing while loop.  If we
         // want to assume that these halos wouldn't have formed galaxies then
         // it should come after the while loop...
+        //
+        // Once a halo has been checked for a new galaxy its list of galaxies is
+        // final for this snapshot, so we also set the merger clocks of any new
+        // infallers and find the first occupied halo of the FOF group here.
         for (int i_fof = 0; i_fof < trees_info.n_fof_groups; i_fof++) {
-            halo_t* cur_halo = fof_group[i_fof].FirstHalo;
+            int i_halo = fof_group[i_fof].FirstHalo;
             int total_subhalo_len = 0;
 
-            while (cur_halo != NULL) {
+            fof_group[i_fof].FirstOccupiedHalo = -1;
+
+            while (i_halo > -1) {
+                halo_t* cur_halo = &(halo[i_halo]);
+
                 if (check_if_valid_host(cur_halo))
                     create_new_galaxy(snapshot, cur_halo, &NGal, &new_gal_counter, &merger_counter);
 
+                // Set the merger target of any incoming galaxies and initialise
+                // the merger clock.  Note that we *increment* the clock immediately
+                // after calculating it. This is because we will decrement the clock
+                // (by the same amount) when checking for mergers in evolve.c
+                // N.B. The halo properties of the galaxies have not yet been
+                // updated, as required by calculate_merging_time().
+                gal = cur_halo->Galaxy;
+                while (gal != NULL) {
+                    if ((gal->Type == 2) && (gal->MergerTarget == NULL)) {
+                        gal->MergerTarget = gal->FirstGalInHalo;
+                        gal->MergTime = calculate_merging_time(gal, snapshot);
+                        gal->MergTime += gal->dt;
+                    }
+                    gal = gal->NextGalInHalo;
+                }
+
+                if ((cur_halo->Galaxy != NULL) && (fof_group[i_fof].FirstOccupiedHalo < 0))
+                    fof_group[i_fof].FirstOccupiedHalo = i_halo;
+
                 total_subhalo_len += cur_halo->Len;
 
-                cur_halo = cur_halo->NextHaloInFOFGroup;
+                i_halo = cur_halo->NextHaloInFOFGroup;
             }
 
             fof_group[i_fof].TotalSubhaloLen = total_subhalo_len;
         }
 
-        // Loop through each galaxy and set the merger clocks for new infallers
-        // now that all other galaxies have been processed and their halo
-        // pointers updated...
+        // We finish by killing any galaxies which were marked for death after
+        // we had already passed them above (i.e. satellites in strayed halos
+        // etc.), copying the halo properties into the galaxy structure of all
+        // galaxies with type<2, passively evolving ghosts, and updating the dt
+        // values for non-ghosts.
+        // N.B. Newly created galaxies are the only ones with a negative
+        // HaloDescIndex which are attached to a halo at this point.
+        prev_gal = NULL;
         gal = run_globals.FirstGal;
-
+        run_globals.NGalaxyListPasses++;
         while (gal != NULL) {
-            if ((gal->Type == 2) && (gal->MergerTarget == NULL)) {
-                // Set the merger target of the incoming galaxy and initialise the
-                // merger clock.  Note that we *increment* the clock immediately
-                // after calculating it. This is because we will decrement the clock
-                // (by the same amount) when checking for mergers in evolve.c
-                gal->MergerTarget = gal->FirstGalInHalo;
-                gal->MergTime = calculate_merging_time(gal, snapshot);
-                gal->MergTime += gal->dt;
-            }
-            gal = gal->Next;
-        }
+            next_gal = gal->Next;
 
-        // Calculate the first occupied halo
-        for (int i_fof = 0; i_fof < trees_info.n_fof_groups; i_fof++) {
-            fof_group[i_fof].FirstOccupiedHalo = NULL;
-            halo_t* cur_halo = fof_group[i_fof].FirstHalo;
-            while (cur_halo != NULL) {
-                if (cur_halo->Galaxy != NULL) {
-                    fof_group[i_fof].FirstOccupiedHalo = cur_halo;
-                    break;
-                }
-                cur_halo = cur_halo->NextHaloInFOFGroup;
+            if ((gal->HaloDescIndex < 0) && (gal->Halo == NULL)) {
+                kill_galaxy(gal, prev_gal, &NGal, &kill_counter);
+                gal = next_gal;
+                continue;
             }
-        }
 
-        // We finish by copying the halo properties into the galaxy structure of
-        // all galaxies with type<2, passively evolving ghosts, and updating the dt
-        // values for non-ghosts.
-        gal = run_globals.FirstGal;
-        while (gal != NULL) {
             if ((gal->Halo == NULL) && (!gal->ghost_flag)) {
                 mlog_error("We missed a galaxy during processing!");
 #ifdef DEBUG
@@ -275,9 +279,13 @@ void dracarys()
             if ((gal->Type < 2) && (!gal->ghost_flag))
                 copy_halo_props_to_galaxy(gal->Halo, gal);
 
-            gal = gal->Next;
+            prev_gal = gal;
+            gal = next_gal;
         }
 
+        // Incase we ended up removing the last galaxy, update the LastGal pointer
+        run_globals.LastGal = prev_gal;
+
 #ifdef DEBUG
         check_counts(fof_group, NGal, trees_info.n_fof_groups);
 #endif
@@ -364,13 +372,11 @@ void dracarys()
                 if (snapshot == run_globals.ListOutputSnaps[i_out])
                     write_snapshot(nout_gals, i_out, &last_nout_gals);
 
-        // Update the LastIdentSnap values for non-ghosts
-        gal = run_globals.FirstGal;
-        while (gal != NULL) {
-            if (!gal->ghost_flag)
-                gal->LastIdentSnap = snapshot;
-            gal = gal->Next;
-        }
+#ifdef DEBUG
+        // Logged after writing so that the passes made by write_snapshot are included
+        MPI_Allreduce(MPI_IN_PLACE, &run_globals.NGalaxyListPasses, 1, MPI_INT, MPI_MAX, run_globals.mpi_comm);
+        mlog("Galaxy list traversals (max rank) :: %d", MLOG_MESG, run_globals.NGalaxyListPasses);
+#endif
 
 #ifdef DEBUG
         check_pointers(halo, fof_group, &trees_info);
@@ -379,6 +385,11 @@ void dracarys()
         if (run_globals.params.FlagMCMC)
             meraxes_mhysa_hook(run_globals.mhysa_self, snapshot, nout_gals);
 
+        // The halo arrays may be reused or freed by the next snapshot, so make
+        // sure nothing can follow the links into them from here on
+        run_globals.CurrentHalo = NULL;
+        run_globals.CurrentFOFGroup = NULL;
+
         mlog("...done", MLOG_CLOSE | MLOG_TIMERSTOP);
     }
 
@@ -390,8 +401,10 @@ void dracarys()
 
         mlog("Resetting halo->galaxy pointers", MLOG_MESG);
         for (int ii = 0; ii < n_store_snapshots; ii++)
-            for (int jj = 0; jj < snapshot_trees_info[ii].n_halos; jj++)
+            for (int jj = 0; jj < snapshot_trees_info[ii].n_halos; jj++) {
                 snapshot_halo[ii][jj].Galaxy = NULL;
+                snapshot_halo[ii][jj].MergerMother = NULL;
+            }
 
         // reset started and finished flags for reionization if needed
         if (run_globals.params.Flag_PatchyReion) {
@@ -400,14 +413,17 @@ void dracarys()
         }
     }
 
+    // N.B. The pool blocks themselves are kept for reuse by later iterations
+    // and are only freed in cleanup().
     mlog("Freeing galaxies...", MLOG_OPEN);
     gal = run_globals.FirstGal;
     while (gal != NULL) {
         next_gal = gal->Next;
-        free(gal);
+        release_galaxy(gal);
         gal = next_gal;
     }
     run_globals.FirstGal = NULL;
+    run_globals.LastGal = NULL;
     mlog("...done", MLOG_CLOSE);
 
     // Create the master file
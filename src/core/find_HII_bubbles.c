@@ -1,4 +1,5 @@
 #include "meraxes.h"
+#include <assert.h>
 #include <fftw3-mpi.h>
 #include <math.h>
 
@@ -35,6 +36,331 @@ double RtoM(double R)
     return -1;
 }
 
+static void report_find_HII_bubbles_memory(size_t bytes_allocated, size_t bytes_working)
+{
+    // Report the bytes allocated for this call and the full working set it touches beyond its input and output
+    // grids (see `_find_HII_bubbles`).  As every working buffer is live for the whole of the filter loop, the
+    // working set is the peak in-call memory of each rank above the resident grids.
+    double bytes[2] = { (double)bytes_allocated, (double)bytes_working };
+    MPI_Allreduce(MPI_IN_PLACE, bytes, 2, MPI_DOUBLE, MPI_MAX, run_globals.mpi_comm);
+
+    mlog("find_HII_bubbles working set = %.1f MB/rank, of which %.1f MB/rank allocated for this call (max over ranks)",
+        MLOG_MESG, bytes[1] / (1024. * 1024.), bytes[0] / (1024. * 1024.));
+}
+
+// Everything the ionisation criterion needs for one filter step
+typedef struct ionisation_step_t {
+    double R;
+    double M_R; // RtoM(R)
+    double R3; // R^3
+    double redshift;
+    double pixel_volume;
+    double ReionEfficiency;
+    double ReionGammaHaloBias;
+    double J_21_aux_constant;
+    double Gamma_R_prefactor;
+    double mass_rate_unit; // UnitMass_in_g / UnitTime_in_s
+    double inv_volume_unit; // (UnitLength_in_cm / Hubble_h)^-3
+    double ReionNionPhotPerBary;
+    bool last_step;
+    bool flag_ReionUVBFlag;
+    bool include_recombinations;
+    bool include_spin_temp;
+} ionisation_step_t;
+
+// Indices of each field in the interleaved filtered buffer
+typedef struct filtered_field_index_t {
+    int n_fields;
+    int deltax;
+    int stars;
+    int sfr;
+    int N_rec;
+    int x_e;
+} filtered_field_index_t;
+
+static bool slab_has_ionising_sources(const fftwf_complex* stars_unfiltered, int slab_n_complex)
+{
+    for (int ii = 0; ii < slab_n_complex; ii++)
+        if (stars_unfiltered[ii] != 0)
+            return true;
+
+    return false;
+}
+
+static fftwf_complex* unfiltered_grid(fftwf_plan r2c_plan, float* grid, float* scratch, int slab_n_complex, double total_n_cells)
+{
+    // Forward transform `grid` in `scratch`, which is returned as the k-space field.  If `scratch` is `grid` itself
+    // then the real space grid is overwritten.
+    // Remember to add the factor of VOLUME/TOT_NUM_PIXELS when converting from real space to k-space
+    // Note: we will leave off factor of VOLUME, in anticipation of the inverse FFT below
+    if (scratch != grid)
+        memcpy(scratch, grid, sizeof(fftwf_complex) * slab_n_complex);
+
+    fftwf_complex* unfiltered = (fftwf_complex*)scratch; // WATCH OUT!
+    reion_fftw_execute_r2c(r2c_plan, scratch, unfiltered);
+
+    // TODO: Double check that looping over correct number of elements here
+    for (int ii = 0; ii < slab_n_complex; ii++)
+        unfiltered[ii] /= total_n_cells;
+
+    return unfiltered;
+}
+
+static void clamp_filtered_fields(float* filtered_real, const filtered_field_index_t* field, int local_nix, int ReionGridDim)
+{
+    // Enforce the physical bounds on the filtered fields to account for aliasing effects.
+    //
+    // The bounds are laid out to match one padded row of interleaved fields so
+    // that the inner loop is a contiguous, branch-free min/max over each row.
+    // N.B. These are only ReionGridDim * n_fields values each so they live on the stack.
+    const int n_fields = field->n_fields;
+    const int row_len = ReionGridDim * n_fields;
+    const ptrdiff_t row_stride = (ptrdiff_t)2 * (ReionGridDim / 2 + 1) * n_fields;
+
+    float lower[row_len];
+    float upper[row_len];
+
+    for (int iz = 0; iz < ReionGridDim; iz++) {
+        float* cell_lower = lower + iz * n_fields;
+        float* cell_upper = upper + iz * n_fields;
+        for (int i_field = 0; i_field < n_fields; i_field++) {
+            cell_lower[i_field] = -INFINITY;
+            cell_upper[i_field] = INFINITY;
+        }
+        cell_lower[field->deltax] = -1 + REL_TOL;
+        cell_lower[field->stars] = 0.0;
+        cell_lower[field->sfr] = 0.0;
+        if (field->N_rec >= 0)
+            cell_lower[field->N_rec] = 0.0;
+        if (field->x_e >= 0) {
+            cell_lower[field->x_e] = 0.0;
+            cell_upper[field->x_e] = (float)0.999;
+        }
+    }
+
+    for (ptrdiff_t i_row = 0; i_row < (ptrdiff_t)local_nix * ReionGridDim; i_row++) {
+        float* restrict row = filtered_real + i_row * row_stride;
+        for (int ii = 0; ii < row_len; ii++)
+            row[ii] = fminf(fmaxf(row[ii], lower[ii]), upper[ii]);
+    }
+}
+
+static void update_ionisation_state_row(const ionisation_step_t* step,
+    int n_cells,
+    const float* restrict deltax,
+    const float* restrict stars,
+    const float* restrict sfr,
+    const float* restrict N_rec,
+    const float* restrict x_e,
+    float* restrict xH,
+    float* restrict r_bubble,
+    float* restrict z_in,
+    float* restrict J_21,
+    float* restrict J_21_at_ionization,
+    float* restrict Gamma12,
+    float* restrict z_re)
+{
+    // Apply the ionisation criterion along one row (fixed ix, iy) of the slab
+    // with each field stored contiguously.
+    //
+    // Every update is written as a select so that this loop vectorises.  Cells
+    // which have already been ionised at a larger radius simply reselect their
+    // current values, with only r_bubble (the smallest ionising radius)
+    // continuing to change.
+
+    // copy the step constants so that they can stay in registers across the stores below
+    const bool last_step = step->last_step;
+    const double M_R = step->M_R;
+    const double R3 = step->R3;
+    const double pixel_volume = step->pixel_volume;
+    const double ReionEfficiency = step->ReionEfficiency;
+    const double J_21_aux_constant = step->J_21_aux_constant;
+    const double Gamma_R_prefactor = step->Gamma_R_prefactor;
+    const double mass_rate_unit = step->mass_rate_unit;
+    const double inv_volume_unit = step->inv_volume_unit;
+    const double ReionNionPhotPerBary = step->ReionNionPhotPerBary;
+    const float R = (float)step->R;
+    const float redshift = (float)step->redshift;
+    const float ReionGammaHaloBias = (float)step->ReionGammaHaloBias;
+
+    // The output rows may be sink rows from the caller's scratch buffer, which defeats GCC's alias analysis
+#pragma GCC ivdep
+    for (int iz = 0; iz < n_cells; iz++) {
+        double density_over_mean = 1.0 + (double)deltax[iz];
+
+        double f_coll_stars = (double)stars[iz] / (M_R * density_over_mean)
+            * (4.0 / 3.0) * M_PI * R3 / pixel_volume;
+
+        double sfr_density = (double)sfr[iz] / pixel_volume; // In internal units
+
+        // Account for recombinations within the cell and the partial ionisation of the cell from X-rays
+        double rec = (double)N_rec[iz] / density_over_mean;
+        double electron_fraction = 1.0 - x_e[iz];
+
+        double Gamma_R = Gamma_R_prefactor * sfr_density * mass_rate_unit * inv_volume_unit
+            * ReionNionPhotPerBary / PROTONMASS; // Convert pixel volume (Mpc/h)^3 -> (cm)^3
+        float J_21_aux = (float)(sfr_density * J_21_aux_constant);
+
+        // Modified reionisation condition, including recombinations and partial ionisations from X-rays
+        bool ionised = f_coll_stars > (electron_fraction / ReionEfficiency) * (1. + rec);
+
+        // Is this the first crossing of the ionisation barrier for this cell (largest R)?
+        float xH_old = xH[iz];
+        bool first_crossing = ionised && (xH_old > REL_TOL);
+
+        // On the last filtering step assign partial ionisations to those cells which aren't fully ionised
+        float xH_partial = (float)(electron_fraction - f_coll_stars * ReionEfficiency);
+        xH_partial = (xH_partial < 0.) ? (float)0. : ((xH_partial > 1.0) ? (float)1. : xH_partial);
+
+        float xH_new = ionised ? (float)0. : ((last_step && (xH_old > REL_TOL)) ? xH_partial : xH_old);
+        xH[iz] = xH_new;
+        r_bubble[iz] = ionised ? R : r_bubble[iz];
+
+        // Store the ionisation background and the reionisation redshift for each cell
+        float z_re_old = z_re[iz];
+        J_21[iz] = first_crossing ? J_21_aux : J_21[iz];
+        Gamma12[iz] = first_crossing ? (float)Gamma_R : Gamma12[iz];
+        z_re[iz] = (first_crossing && (z_re_old < 0)) ? redshift : z_re_old;
+
+        // Check if new ionisation, i.e. (xH_new < REL_TOL) && (z_in_old < 0).  N.B. This is written as a
+        // single comparison because GCC can't combine the double and float precision masks here.
+        float z_in_old = z_in[iz];
+        bool new_ionisation = fmaxf(xH_new - REL_TOL, z_in_old) < 0;
+        z_in[iz] = new_ionisation ? redshift : z_in_old;
+        J_21_at_ionization[iz] = new_ionisation ? J_21_aux * ReionGammaHaloBias : J_21_at_ionization[iz];
+    }
+}
+
+static bool row_is_converged(int n_cells, const float* restrict xH, const float* restrict z_in)
+{
+    // A cell which has already been flagged as ionised (xH == 0 and a recorded
+    // z_at_ionization) can no longer change its xH, J_21, Gamma12, z_re or
+    // z_at_ionization.
+    for (int iz = 0; iz < n_cells; iz++)
+        if ((xH[iz] != 0) || (z_in[iz] < 0))
+            return false;
+    return true;
+}
+
+static void update_r_bubble_row(const ionisation_step_t* step,
+    int n_cells,
+    const float* restrict deltax,
+    const float* restrict stars,
+    const float* restrict N_rec,
+    const float* restrict x_e,
+    float* restrict r_bubble)
+{
+    // The ionisation criterion for a row of converged cells (see `row_is_converged`).  Only r_bubble (the
+    // smallest ionising radius) can still change, so this is all that is evaluated.
+    const double M_R = step->M_R;
+    const double R3 = step->R3;
+    const double pixel_volume = step->pixel_volume;
+    const double ReionEfficiency = step->ReionEfficiency;
+    const float R = (float)step->R;
+
+    for (int iz = 0; iz < n_cells; iz++) {
+        double density_over_mean = 1.0 + (double)deltax[iz];
+
+        double f_coll_stars = (double)stars[iz] / (M_R * density_over_mean)
+            * (4.0 / 3.0) * M_PI * R3 / pixel_volume;
+
+        double rec = (double)N_rec[iz] / density_over_mean;
+        double electron_fraction = 1.0 - x_e[iz];
+
+        bool ionised = f_coll_stars > (electron_fraction / ReionEfficiency) * (1. + rec);
+        r_bubble[iz] = ionised ? R : r_bubble[iz];
+    }
+}
+
+static bool update_ionisation_state(const ionisation_step_t* step,
+    const float* restrict filtered_real,
+    const filtered_field_index_t* field,
+    int local_nix,
+    int ReionGridDim,
+    float* restrict xH,
+    float* restrict J_21,
+    float* restrict Gamma12,
+    float* restrict z_re,
+    float* restrict r_bubble,
+    float* restrict z_in,
+    float* restrict J_21_at_ionization,
+    bool use_convergence_mask)
+{
+    // Apply the ionisation criterion at this filter step to every cell in the slab.
+    //
+    // When `use_convergence_mask` is set, rows in which every cell has already
+    // been flagged as ionised only have their r_bubble values updated.
+    // N.B. r_bubble records the smallest ionising radius so these rows are
+    // never completely done.  The mask is applied per row rather than per cell
+    // so that the criterion loops still vectorise.
+    //
+    // Returns true if every row in the slab has converged after this step.
+
+    const int n_fields = field->n_fields;
+    const ptrdiff_t row_stride = (ptrdiff_t)2 * (ReionGridDim / 2 + 1) * n_fields;
+    const bool flag_ReionUVBFlag = step->flag_ReionUVBFlag;
+    const bool include_recombinations = step->include_recombinations;
+    const bool include_spin_temp = step->include_spin_temp;
+
+    const int i_field_deltax = field->deltax;
+    const int i_field_stars = field->stars;
+    const int i_field_sfr = field->sfr;
+    const int i_field_N_rec = field->N_rec;
+    const int i_field_x_e = field->x_e;
+
+    // Each padded row of interleaved fields is first split into contiguous per-field rows.  Fields which
+    // aren't present are zeroed, which gives exactly rec = 0 and electron_fraction = 1 without any branches.
+    // Likewise, outputs which aren't being tracked are written to a sink row rather than behind a branch.
+    // N.B. Every input row is filled before it is read, so the (stack) row buffer needs no initialisation.
+    float row_buffer[9 * ReionGridDim];
+    float* deltax_row = row_buffer;
+    float* stars_row = deltax_row + ReionGridDim;
+    float* sfr_row = stars_row + ReionGridDim;
+    float* N_rec_row = sfr_row + ReionGridDim;
+    float* x_e_row = N_rec_row + ReionGridDim;
+    float* J_21_sink = x_e_row + ReionGridDim;
+    float* J_21_at_ionization_sink = J_21_sink + ReionGridDim;
+    float* Gamma12_sink = J_21_at_ionization_sink + ReionGridDim;
+    float* z_re_sink = Gamma12_sink + ReionGridDim;
+    bool all_converged = true;
+
+    for (int ix = 0; ix < local_nix; ix++)
+        for (int iy = 0; iy < ReionGridDim; iy++) {
+            const ptrdiff_t i_row = (ptrdiff_t)ix * ReionGridDim + iy;
+            const float* row = filtered_real + i_row * row_stride;
+            const ptrdiff_t i_real_start = i_row * ReionGridDim;
+            const bool converged = use_convergence_mask && row_is_converged(ReionGridDim, xH + i_real_start, z_in + i_real_start);
+
+            for (int iz = 0; iz < ReionGridDim; iz++) {
+                const float* cell = row + (ptrdiff_t)iz * n_fields;
+                deltax_row[iz] = cell[i_field_deltax];
+                stars_row[iz] = cell[i_field_stars];
+                sfr_row[iz] = cell[i_field_sfr];
+                N_rec_row[iz] = include_recombinations ? cell[i_field_N_rec] : (float)0.;
+                x_e_row[iz] = include_spin_temp ? cell[i_field_x_e] : (float)0.;
+            }
+
+            if (converged) {
+                update_r_bubble_row(step, ReionGridDim, deltax_row, stars_row, N_rec_row, x_e_row, r_bubble + i_real_start);
+                continue;
+            }
+
+            update_ionisation_state_row(step, ReionGridDim,
+                deltax_row, stars_row, sfr_row, N_rec_row, x_e_row,
+                xH + i_real_start,
+                r_bubble + i_real_start,
+                z_in + i_real_start,
+                flag_ReionUVBFlag ? J_21 + i_real_start : J_21_sink,
+                flag_ReionUVBFlag ? J_21_at_ionization + i_real_start : J_21_at_ionization_sink,
+                include_recombinations ? Gamma12 + i_real_start : Gamma12_sink,
+                include_recombinations ? z_re + i_real_start : z_re_sink);
+
+            all_converged = all_converged && row_is_converged(ReionGridDim, xH + i_real_start, z_in + i_real_start);
+        }
+
+    return all_converged;
+}
+
 void _find_HII_bubbles(int snapshot)
 {
     // TODO: TAKE A VERY VERY CLOSE LOOK AT UNITS!!!!
@@ -51,15 +377,11 @@ void _find_HII_bubbles(int snapshot)
     double ReionEfficiency = run_globals.params.physics.ReionEfficiency;
     double ReionNionPhotPerBary = run_globals.params.physics.ReionNionPhotPerBary;
     run_units_t* units = &(run_globals.units);
-    float J_21_aux = 0;
     double J_21_aux_constant;
     double density_over_mean;
-    double sfr_density;
-    double f_coll_stars;
-    double electron_fraction;
-    double Gamma_R_prefactor;
+    double Gamma_R_prefactor = 0.0;
 
-    double dNrec, rec, Gamma_R;
+    double dNrec;
     float fabs_dtdz, ZSTEP, z_eff;
 
     double redshift = run_globals.ZZ[snapshot];
@@ -74,11 +396,11 @@ void _find_HII_bubbles(int snapshot)
     ZSTEP = (float)(prev_redshift - redshift);
     fabs_dtdz = (float)fabs(dtdz((float)redshift) / run_globals.params.Hubble_h);
 
-    // Initialise interpolation tables for inhomogeneous recombinations
-    // TODO(merge): Does this need to be done every call?
-    if(run_globals.params.Flag_IncludeRecombinations) {
-        init_MHR();
-    }
+    // The working buffers are only allocated for the duration of the call in lean memory mode
+    bool lean_memory = run_globals.params.ReionLeanMemory;
+    size_t bytes_allocated = 0;
+    if (lean_memory)
+        bytes_allocated = malloc_find_HII_bubbles_buffers();
 
     int i_real;
     int i_padded;
@@ -131,90 +453,66 @@ void _find_HII_bubbles(int snapshot)
     // #endif
 
     // Forward fourier transform to obtain k-space fields
-    // TODO: Ensure that fftwf_mpi_init has been called and fftwf_mpi_cleanup will be called
-    // TODO: Don't use estimate and calculate plan in code init
-    float* deltax = run_globals.reion_grids.deltax;
-    float* deltax_temp = run_globals.reion_grids.deltax_temp;
-
-    // Make a copy of the box for FFT'ing
-    memcpy(deltax_temp, deltax, sizeof(fftwf_complex) * slab_n_complex);
-
-    fftwf_complex* deltax_unfiltered = (fftwf_complex*)deltax_temp; // WATCH OUT!
-    fftwf_complex* deltax_filtered = run_globals.reion_grids.deltax_filtered;
-    fftwf_plan plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, deltax_temp, deltax_unfiltered, run_globals.mpi_comm, FFTW_ESTIMATE);
-    fftwf_execute(plan);
-    fftwf_destroy_plan(plan);
+    // N.B. The plans are created once in `create_reion_fftw_plans` and executed here on each grid
+    fftwf_plan r2c_plan = run_globals.reion_grids.r2c_plan;
+    fftwf_plan c2r_many_plan = run_globals.reion_grids.c2r_many_plan;
 
+    float* deltax = run_globals.reion_grids.deltax;
     float* stars = run_globals.reion_grids.stars;
-    float* stars_temp = run_globals.reion_grids.stars_temp;
-
-    // Make a copy of the box for FFT'ing
-    memcpy(stars_temp, stars, sizeof(fftwf_complex) * slab_n_complex);
-
-    fftwf_complex* stars_unfiltered = (fftwf_complex*)stars_temp; // WATCH OUT!
-    fftwf_complex* stars_filtered = run_globals.reion_grids.stars_filtered;
-    plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, stars_temp, stars_unfiltered, run_globals.mpi_comm, FFTW_ESTIMATE);
-    fftwf_execute(plan);
-    fftwf_destroy_plan(plan);
-
     float* sfr = run_globals.reion_grids.sfr;
     float* sfr_temp = run_globals.reion_grids.sfr_temp;
 
-    // Make a copy of the box for FFT'ing
-    memcpy(sfr_temp, sfr, sizeof(fftwf_complex) * slab_n_complex);
-
-    fftwf_complex* sfr_unfiltered = (fftwf_complex*)sfr_temp; // WATCH OUT!
-    fftwf_complex* sfr_filtered = run_globals.reion_grids.sfr_filtered;
-    plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, sfr_temp, sfr_unfiltered, run_globals.mpi_comm, FFTW_ESTIMATE);
-    fftwf_execute(plan);
-    fftwf_destroy_plan(plan);
+    // Each input grid is forward transformed once per call.  By default the k-space fields are held in their own
+    // working slabs.  In lean memory mode they aren't: deltax is transformed in sfr_temp (which is always resident)
+    // and stars and sfr in place, as neither real space grid is used again before it is rebuilt at the next
+    // snapshot.  This takes two slabs off the working set without any extra transforms, and gives identical
+    // results.  N_rec accumulates between snapshots, so it is always transformed in a copy.
+    float* deltax_scratch = lean_memory ? sfr_temp : run_globals.reion_grids.deltax_temp;
+    float* stars_scratch = lean_memory ? stars : run_globals.reion_grids.stars_temp;
+    float* sfr_scratch = lean_memory ? sfr : sfr_temp;
+    fftwf_complex* deltax_unfiltered = unfiltered_grid(r2c_plan, deltax, deltax_scratch, slab_n_complex, total_n_cells);
+    fftwf_complex* stars_unfiltered = unfiltered_grid(r2c_plan, stars, stars_scratch, slab_n_complex, total_n_cells);
+    fftwf_complex* sfr_unfiltered = unfiltered_grid(r2c_plan, sfr, sfr_scratch, slab_n_complex, total_n_cells);
+    fftwf_complex* N_rec_unfiltered = NULL;
 
     // The free electron fraction from X-rays
     float* x_e_box;
     fftwf_complex* x_e_unfiltered;
-    fftwf_complex* x_e_filtered;
     if(run_globals.params.Flag_IncludeSpinTemp) {
         x_e_box = run_globals.reion_grids.x_e_box;
         x_e_unfiltered = (fftwf_complex*)x_e_box; // WATCH OUT!
-        x_e_filtered = run_globals.reion_grids.x_e_filtered;
-        plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, x_e_box, x_e_unfiltered, run_globals.mpi_comm, FFTW_ESTIMATE);
-        fftwf_execute(plan);
-        fftwf_destroy_plan(plan);
+        reion_fftw_execute_r2c(r2c_plan, x_e_box, x_e_unfiltered);
+
+        for (int ii = 0; ii < slab_n_complex; ii++)
+            x_e_unfiltered[ii] /= total_n_cells;
     }
 
     // Fields relevant for computing the inhomogeneous recombinations
-    float *z_re, *Gamma12, *N_rec_prev, *N_rec;
-    fftwf_complex* N_rec_unfiltered;
-    fftwf_complex* N_rec_filtered;
+    float *z_re = NULL, *Gamma12 = NULL, *N_rec;
     if(run_globals.params.Flag_IncludeRecombinations) {
         z_re = run_globals.reion_grids.z_re;
         Gamma12 = run_globals.reion_grids.Gamma12;
 
         N_rec = run_globals.reion_grids.N_rec;
-        N_rec_prev = run_globals.reion_grids.N_rec_prev;
-
-        // Make a copy of the box for FFT'ing
-        memcpy(N_rec_prev, N_rec, sizeof(fftwf_complex) * slab_n_complex);
-
-        N_rec_unfiltered = (fftwf_complex*)N_rec_prev; // WATCH OUT!
-        N_rec_filtered = run_globals.reion_grids.N_rec_filtered;
-        plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim, N_rec_prev, N_rec_unfiltered, run_globals.mpi_comm, FFTW_ESTIMATE);
+        N_rec_unfiltered = unfiltered_grid(r2c_plan, N_rec, run_globals.reion_grids.N_rec_prev, slab_n_complex, total_n_cells);
     }
 
-    // Remember to add the factor of VOLUME/TOT_NUM_PIXELS when converting from real space to k-space
-    // Note: we will leave off factor of VOLUME, in anticipation of the inverse FFT below
-    // TODO: Double check that looping over correct number of elements here
-    for (int ii = 0; ii < slab_n_complex; ii++) {
-        deltax_unfiltered[ii] /= total_n_cells;
-        stars_unfiltered[ii] /= total_n_cells;
-        sfr_unfiltered[ii] /= total_n_cells;
-        if(run_globals.params.Flag_IncludeRecombinations) {
-            N_rec_unfiltered[ii] /= total_n_cells;
-        }
-        if(run_globals.params.Flag_IncludeSpinTemp) {
-            x_e_unfiltered[ii] /= total_n_cells;
-        }
-    }
+    // The filtered fields are interleaved in a single buffer (see `malloc_reionization_grids` for the order)
+    fftwf_complex* filtered_fields = run_globals.reion_grids.filtered_fields;
+    float* filtered_real = (float*)filtered_fields;
+    int n_fields = run_globals.reion_grids.n_filtered_fields;
+    int i_field_deltax = 0;
+    int i_field_stars = 1;
+    int i_field_sfr = 2;
+    int i_field_N_rec = -1;
+    int i_field_x_e = -1;
+    int n_fields_used = 3;
+    if(run_globals.params.Flag_IncludeRecombinations)
+        i_field_N_rec = n_fields_used++;
+    if(run_globals.params.Flag_IncludeSpinTemp)
+        i_field_x_e = n_fields_used++;
+    assert(n_fields_used == n_fields);
+    ptrdiff_t i_fields;
 
     // Loop through filter radii
     double ReionRBubbleMax;
@@ -231,12 +529,44 @@ void _find_HII_bubbles(int snapshot)
 
     bool flag_last_filter_step = false;
 
-    // set recombinations to zero (for case when recombinations are not used)
-    rec = 0.0;
+    // r_bubble is only used in the output grids (see `save_reion_output_grids`)
+    bool flag_r_bubble_needed = false;
+    if (run_globals.params.Flag_OutputGrids)
+        for (int i_out = 0; i_out < run_globals.NOutputSnaps; i_out++)
+            if (snapshot == run_globals.ListOutputSnaps[i_out])
+                flag_r_bubble_needed = true;
+
+    // With no ionising sources anywhere in the box f_coll_stars is identically zero at every radius and no
+    // cell can cross the ionisation barrier, so only the final (unfiltered) step can change anything.
+    int flag_has_sources = slab_has_ionising_sources(stars_unfiltered, slab_n_complex);
+    MPI_Allreduce(MPI_IN_PLACE, &flag_has_sources, 1, MPI_INT, MPI_LOR, run_globals.mpi_comm);
+    bool flag_skip_to_last_step = (!flag_has_sources) && (ReionEfficiency > 0);
+
+    ionisation_step_t step = {
+        .redshift = redshift,
+        .pixel_volume = pixel_volume,
+        .ReionEfficiency = ReionEfficiency,
+        .ReionGammaHaloBias = ReionGammaHaloBias,
+        .mass_rate_unit = units->UnitMass_in_g / units->UnitTime_in_s,
+        .inv_volume_unit = pow(units->UnitLength_in_cm / run_globals.params.Hubble_h, -3.),
+        .ReionNionPhotPerBary = ReionNionPhotPerBary,
+        .flag_ReionUVBFlag = flag_ReionUVBFlag,
+        .include_recombinations = run_globals.params.Flag_IncludeRecombinations,
+        .include_spin_temp = run_globals.params.Flag_IncludeSpinTemp,
+    };
+
+    filtered_field_index_t field_index = {
+        .n_fields = n_fields,
+        .deltax = i_field_deltax,
+        .stars = i_field_stars,
+        .sfr = i_field_sfr,
+        .N_rec = i_field_N_rec,
+        .x_e = i_field_x_e,
+    };
 
     while (!flag_last_filter_step) {
         // check to see if this is our last filtering step
-        if (((R / ReionDeltaRFactor) <= (cell_length_factor * box_size / (double)ReionGridDim))
+        if (flag_skip_to_last_step || ((R / ReionDeltaRFactor) <= (cell_length_factor * box_size / (double)ReionGridDim))
                 || ((R / ReionDeltaRFactor) <= ReionRBubbleMin)) {
             flag_last_filter_step = true;
             R = cell_length_factor * box_size / (double)ReionGridDim;
@@ -246,75 +576,31 @@ void _find_HII_bubbles(int snapshot)
         // mlog("R = %.2e (h=0.678 -> %.2e)", MLOG_MESG, R, R/0.678);
         mlog(".", MLOG_CONT);
 
-        // copy the k-space grids
-        memcpy(deltax_filtered, deltax_unfiltered, sizeof(fftwf_complex) * slab_n_complex);
-        memcpy(stars_filtered, stars_unfiltered, sizeof(fftwf_complex) * slab_n_complex);
-        memcpy(sfr_filtered, sfr_unfiltered, sizeof(fftwf_complex) * slab_n_complex);
-
-        if(run_globals.params.Flag_IncludeRecombinations) {
-            memcpy(N_rec_filtered, N_rec_unfiltered, sizeof(fftwf_complex) * slab_n_complex);
-        }
-        if(run_globals.params.Flag_IncludeSpinTemp) {
-            memcpy(x_e_filtered, x_e_unfiltered, sizeof(fftwf_complex) * slab_n_complex);
-        }
-
-        // do the filtering unless this is the last filter step
-        int local_ix_start = (int)(run_globals.reion_grids.slab_ix_start[run_globals.mpi_rank]);
-        if (!flag_last_filter_step) {
-            filter(deltax_filtered, local_ix_start, local_nix, ReionGridDim, (float)R, run_globals.params.ReionFilterType);
-            filter(stars_filtered, local_ix_start, local_nix, ReionGridDim, (float)R, run_globals.params.ReionFilterType);
-            filter(sfr_filtered, local_ix_start, local_nix, ReionGridDim, (float)R, run_globals.params.ReionFilterType);
-
+        // copy the k-space grids into the interleaved filtering buffer
+        for (int ii = 0; ii < slab_n_complex; ii++) {
+            fftwf_complex* cell = filtered_fields + (ptrdiff_t)ii * n_fields;
+            cell[i_field_deltax] = deltax_unfiltered[ii];
+            cell[i_field_stars] = stars_unfiltered[ii];
+            cell[i_field_sfr] = sfr_unfiltered[ii];
             if(run_globals.params.Flag_IncludeRecombinations) {
-                filter(N_rec_filtered, local_ix_start, local_nix, ReionGridDim, (float)R, run_globals.params.ReionFilterType);
+                cell[i_field_N_rec] = N_rec_unfiltered[ii];
             }
             if(run_globals.params.Flag_IncludeSpinTemp) {
-                filter(x_e_filtered, local_ix_start, local_nix, ReionGridDim, (float)R, run_globals.params.ReionFilterType);
+                cell[i_field_x_e] = x_e_unfiltered[ii];
             }
         }
 
-        // inverse fourier transform back to real space
-        plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim, deltax_filtered, (float*)deltax_filtered, run_globals.mpi_comm, FFTW_ESTIMATE);
-        fftwf_execute(plan);
-        fftwf_destroy_plan(plan);
-
-        plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim, stars_filtered, (float*)stars_filtered, run_globals.mpi_comm, FFTW_ESTIMATE);
-        fftwf_execute(plan);
-        fftwf_destroy_plan(plan);
-
-        plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim, sfr_filtered, (float*)sfr_filtered, run_globals.mpi_comm, FFTW_ESTIMATE);
-        fftwf_execute(plan);
-        fftwf_destroy_plan(plan);
-
-        if(run_globals.params.Flag_IncludeRecombinations) {
-            plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim, N_rec_filtered, (float*)N_rec_filtered, run_globals.mpi_comm, FFTW_ESTIMATE);
-            fftwf_execute(plan);
-            fftwf_destroy_plan(plan);
+        // do the filtering unless this is the last filter step
+        int local_ix_start = (int)(run_globals.reion_grids.slab_ix_start[run_globals.mpi_rank]);
+        if (!flag_last_filter_step) {
+            filter_many(filtered_fields, n_fields, local_ix_start, local_nix, ReionGridDim, (float)R, run_globals.params.ReionFilterType);
         }
 
-        if(run_globals.params.Flag_IncludeSpinTemp) {
-            plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim, x_e_filtered, (float*)x_e_filtered, run_globals.mpi_comm, FFTW_ESTIMATE);
-            fftwf_execute(plan);
-            fftwf_destroy_plan(plan);
-        }
+        // inverse fourier transform all of the fields back to real space at once
+        reion_fftw_execute_c2r(c2r_many_plan, filtered_fields, filtered_real);
 
         // Perform sanity checks to account for aliasing effects
-        for (int ix = 0; ix < local_nix; ix++)
-            for (int iy = 0; iy < ReionGridDim; iy++)
-                for (int iz = 0; iz < ReionGridDim; iz++) {
-                    i_padded = grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED);
-                    ((float*)deltax_filtered)[i_padded] = fmaxf(((float*)deltax_filtered)[i_padded], -1 + REL_TOL);
-                    ((float*)stars_filtered)[i_padded] = fmaxf(((float*)stars_filtered)[i_padded], 0.0);
-                    ((float*)sfr_filtered)[i_padded] = fmaxf(((float*)sfr_filtered)[i_padded], 0.0);
-
-                    if(run_globals.params.Flag_IncludeRecombinations) {
-                        ((float*)N_rec_filtered)[i_padded] = fmaxf(((float*)N_rec_filtered)[i_padded], 0.0);
-                    }
-                    if(run_globals.params.Flag_IncludeSpinTemp) {
-                        ((float*)x_e_filtered)[i_padded] = fmaxf(((float*)x_e_filtered)[i_padded], 0.0);
-                        ((float*)x_e_filtered)[i_padded] = fminf(((float*)x_e_filtered)[i_padded], 0.999);
-                    }
-                }
+        clamp_filtered_fields(filtered_real, &field_index, local_nix, ReionGridDim);
 
         // #ifdef DEBUG
         //   {
@@ -378,93 +664,26 @@ void _find_HII_bubbles(int snapshot)
         //           ABORT(EXIT_SUCCESS);
         //       }
 
-        for (int ix = 0; ix < local_nix; ix++)
-            for (int iy = 0; iy < ReionGridDim; iy++)
-                for (int iz = 0; iz < ReionGridDim; iz++) {
-                    i_real = grid_index(ix, iy, iz, ReionGridDim, INDEX_REAL);
-                    i_padded = grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED);
+        step.R = R;
+        step.M_R = RtoM(R);
+        step.R3 = pow(R, 3.0);
+        step.last_step = flag_last_filter_step;
+        step.J_21_aux_constant = J_21_aux_constant;
+        step.Gamma_R_prefactor = Gamma_R_prefactor;
+
+        int flag_all_converged = update_ionisation_state(&step, filtered_real, &field_index, local_nix, ReionGridDim,
+            xH, J_21, Gamma12, z_re, r_bubble, run_globals.reion_grids.z_at_ionization,
+            run_globals.reion_grids.J_21_at_ionization, true);
+
+        // Once every cell in the box has been flagged as ionised, r_bubble is the only thing that the remaining
+        // radii can change (see `row_is_converged`).  Unless it is being output at this snapshot we are done.
+        // N.B. The global neutral fractions below are then exactly zero whichever radius deltax was filtered at.
+        if (!flag_r_bubble_needed && !flag_last_filter_step) {
+            MPI_Allreduce(MPI_IN_PLACE, &flag_all_converged, 1, MPI_INT, MPI_LAND, run_globals.mpi_comm);
+            if (flag_all_converged)
+                break;
+        }
 
-                    density_over_mean = 1.0 + (double)((float*)deltax_filtered)[i_padded];
-
-                    f_coll_stars = (double)((float*)stars_filtered)[i_padded] / (RtoM(R) * density_over_mean)
-                        * (4.0 / 3.0) * M_PI * pow(R, 3.0) / pixel_volume;
-
-                    sfr_density = (double)((float*)sfr_filtered)[i_padded] / pixel_volume; // In internal units
-
-                    // #ifdef DEBUG
-                    //           if(abs(redshift - 23.074) < 0.01)
-                    //             debug("%d, %d, %d, %d, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g, %g\n",
-                    //                 run_globals.mpi_rank, ix, iy, iz,
-                    //                 R, density_over_mean, f_coll_stars,
-                    //                 ((float *)stars_filtered)[grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED)],
-                    //                 RtoM(R), (4.0/3.0)*M_PI*pow(R,3.0), pixel_volume, 1.0/ReionEfficiency, sfr_density, ((float*)sfr_filtered)[grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED)], (float)(sfr_density * J_21_aux_constant));
-                    // #endif
-
-                    // Calculate the recombinations within the cell
-                    if(run_globals.params.Flag_IncludeRecombinations) {
-                        Gamma_R = Gamma_R_prefactor * sfr_density * (units->UnitMass_in_g / units->UnitTime_in_s) * pow( units->UnitLength_in_cm / run_globals.params.Hubble_h, -3. )
-                            *  ReionNionPhotPerBary / PROTONMASS; // Convert pixel volume (Mpc/h)^3 -> (cm)^3
-                        rec = (double)((float*)N_rec_filtered)[i_padded] / density_over_mean;
-                    }
-
-                    // Account for the partial ionisation of the cell from X-rays
-                    if(run_globals.params.Flag_IncludeSpinTemp) {
-                        electron_fraction = 1.0 - ((float*)x_e_filtered)[i_padded];
-                    }
-                    else {
-                        electron_fraction = 1.0;
-                    }
-
-                    if (flag_ReionUVBFlag)
-                        J_21_aux = (float)(sfr_density * J_21_aux_constant);
-
-                    // Modified reionisation condition, including recombinations and partial ionisations from X-rays
-                    // Check if ionised!
-                    if (f_coll_stars > ( electron_fraction / ReionEfficiency ) * (1. + rec) ) // IONISED!!!!
-                    {
-                        // If it is the first crossing of the ionisation barrier for this cell (largest R), let's record J_21
-                        if (xH[i_real] > REL_TOL) {
-                            if (flag_ReionUVBFlag)
-                                J_21[i_real] = J_21_aux;
-
-                            // Store the ionisation background and the reionisation redshift for each cell
-                            if(run_globals.params.Flag_IncludeRecombinations) {
-                                Gamma12[i_real] = (float)Gamma_R;
-                                if(z_re[i_real] < 0) {
-                                    z_re[i_real] = (float)redshift;
-                                }
-                            }
-                        }
-
-                        // Mark as ionised
-                        xH[i_real] = 0;
-
-                        // Record radius
-                        r_bubble[i_real] = (float)R;
-                    }
-                    // Check if this is the last filtering step.
-                    // If so, assign partial ionisations to those cells which aren't fully ionised
-                    else if (flag_last_filter_step && (xH[i_real] > REL_TOL))
-                    {
-                        xH[i_real] = (float)(electron_fraction - f_coll_stars * ReionEfficiency);
-                        if(xH[i_real] < 0.) {
-                            xH[i_real] = (float)0.;
-                        }
-                        else if (xH[i_real] > 1.0) {
-                            xH[i_real] = (float)1.;
-                        }
-                    }
-
-                    // Check if new ionisation
-                    float* z_in = run_globals.reion_grids.z_at_ionization;
-                    if ((xH[i_real] < REL_TOL) && (z_in[i_real] < 0)) // New ionisation!
-                    {
-                        z_in[i_real] = (float)redshift;
-                        if (flag_ReionUVBFlag)
-                            run_globals.reion_grids.J_21_at_ionization[i_real] = J_21_aux * (float)ReionGammaHaloBias;
-                    }
-                }
-        // iz
         R /= ReionDeltaRFactor;
     }
 
@@ -479,9 +698,9 @@ void _find_HII_bubbles(int snapshot)
         for (int iy = 0; iy < ReionGridDim; iy++)
             for (int iz = 0; iz < ReionGridDim; iz++) {
                 i_real = grid_index(ix, iy, iz, ReionGridDim, INDEX_REAL);
-                i_padded = grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED);
+                i_fields = (ptrdiff_t)grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED) * n_fields;
                 volume_weighted_global_xH += (double)xH[i_real];
-                density_over_mean = 1.0 + (double)((float*)deltax_filtered)[i_padded];
+                density_over_mean = 1.0 + (double)filtered_real[i_fields + i_field_deltax];
                 mass_weighted_global_xH += (double)(xH[i_real]) * density_over_mean;
                 mass_weight += density_over_mean;
             }
@@ -510,10 +729,14 @@ void _find_HII_bubbles(int snapshot)
 
                 }
 
-        // TODO(merge): Does this need to be done every call?
-        free_MHR();
     }
 
+    size_t bytes_working = run_globals.reion_grids.find_HII_bubbles_buffer_bytes
+        + sizeof(fftwf_complex) * (size_t)slab_n_complex // sfr_temp
+        + filter_kernel_bytes();
+    if (lean_memory)
+        free_find_HII_bubbles_buffers();
+    report_find_HII_bubbles_memory(bytes_allocated, bytes_working);
 }
 
 // This function makes sure that the right version of find_HII_bubbles() gets called.
@@ -2,9 +2,95 @@
 #include "tree_flags.h"
 #include <assert.h>
 
+void init_galaxy_pool()
+{
+    galaxy_pool_t* pool = &(run_globals.GalaxyPool);
+
+    pool->n_blocks_max = 16;
+    pool->blocks = malloc(sizeof(galaxy_t*) * pool->n_blocks_max);
+    pool->aux_blocks = malloc(sizeof(galaxy_aux_t*) * pool->n_blocks_max);
+    pool->n_blocks = 0;
+    pool->free_list = NULL;
+    pool->n_used = 0;
+}
+
+void free_galaxy_pool()
+{
+    galaxy_pool_t* pool = &(run_globals.GalaxyPool);
+
+    for (int ii = 0; ii < pool->n_blocks; ii++) {
+        free(pool->blocks[ii]);
+        free(pool->aux_blocks[ii]);
+    }
+    free(pool->blocks);
+    free(pool->aux_blocks);
+
+    pool->blocks = NULL;
+    pool->aux_blocks = NULL;
+    pool->free_list = NULL;
+    pool->n_blocks = 0;
+    pool->n_blocks_max = 0;
+    pool->n_used = 0;
+}
+
+static void grow_galaxy_pool(galaxy_pool_t* pool)
+{
+    if (pool->n_blocks == pool->n_blocks_max) {
+        pool->n_blocks_max *= 2;
+        pool->blocks = realloc(pool->blocks, sizeof(galaxy_t*) * pool->n_blocks_max);
+        pool->aux_blocks = realloc(pool->aux_blocks, sizeof(galaxy_aux_t*) * pool->n_blocks_max);
+    }
+
+    galaxy_t* block = malloc(sizeof(galaxy_t) * GALAXY_POOL_BLOCK_SIZE);
+    galaxy_aux_t* aux_block = malloc(sizeof(galaxy_aux_t) * GALAXY_POOL_BLOCK_SIZE);
+    if ((block == NULL) || (aux_block == NULL)) {
+        mlog_error("Failed to allocate galaxy pool block %d.", pool->n_blocks);
+        ABORT(EXIT_FAILURE);
+    }
+    pool->blocks[pool->n_blocks] = block;
+    pool->aux_blocks[pool->n_blocks] = aux_block;
+    pool->n_blocks++;
+
+    // Thread the new block onto the free list back to front so that
+    // consecutive allocations walk forwards through memory.  Each galaxy is
+    // permanently paired with the auxiliary slot at the same position.
+    for (int ii = GALAXY_POOL_BLOCK_SIZE - 1; ii >= 0; ii--) {
+        block[ii].Aux = &aux_block[ii];
+        block[ii].Next = pool->free_list;
+        pool->free_list = &block[ii];
+    }
+
+    mlog("Grew galaxy pool to %d blocks (%lld galaxies).", MLOG_MESG, pool->n_blocks,
+        (long long)pool->n_blocks * GALAXY_POOL_BLOCK_SIZE);
+}
+
+galaxy_t* alloc_galaxy()
+{
+    galaxy_pool_t* pool = &(run_globals.GalaxyPool);
+
+    if (pool->free_list == NULL)
+        grow_galaxy_pool(pool);
+
+    galaxy_t* gal = pool->free_list;
+    pool->free_list = gal->Next;
+    pool->n_used++;
+
+    return gal;
+}
+
+void release_galaxy(galaxy_t* gal)
+{
+    galaxy_pool_t* pool = &(run_globals.GalaxyPool);
+
+    // Killed galaxies are reused first, keeping the live set compact
+    gal->Next = pool->free_list;
+    pool->free_list = gal;
+    pool->n_used--;
+}
+
 galaxy_t* new_galaxy(int snapshot, unsigned long halo_ID)
 {
-    galaxy_t* gal = malloc(sizeof(galaxy_t));
+    galaxy_t* gal = alloc_galaxy();
 
     // Initialise the properties
     gal->ID = (unsigned long)(snapshot * 1e10 + halo_ID);
@@ -44,8 +130,8 @@ galaxy_t* new_galaxy(int snapshot, unsigned long halo_ID)
     gal->Fesc = 1.0;
     gal->FescWeightedGSM = 0.0;
     gal->MetalsStellarMass = 0.0;
-    gal->mwmsa_num = 0.0;
-    gal->mwmsa_denom = 0.0;
+    gal->Aux->mwmsa_num = 0.0;
+    gal->Aux->mwmsa_denom = 0.0;
     gal->BlackHoleMass = run_globals.params.physics.BlackHoleSeed;
     gal->FescBH = 1.0;
     gal->BHemissivity = 0.0;
@@ -54,13 +140,13 @@ galaxy_t* new_galaxy(int snapshot, unsigned long halo_ID)
     gal->BlackHoleAccretedColdMass = 0.0;
     gal->BlackHoleAccretingColdMass = 0.0;
     gal->Sfr = 0.0;
-    gal->Cos_Inc = gsl_rng_uniform(run_globals.random_generator);
+    gal->Aux->Cos_Inc = gsl_rng_uniform(run_globals.random_generator);
     gal->MergTime = 99999.9;
     gal->BaryonFracModifier = 1.0;
     gal->FOFMvirModifier = 1.0;
     gal->MvirCrit = 0.0;
     gal->MergerBurstMass = 0.0;
-    gal->MergerStartRadius = 0.0;
+    gal->Aux->MergerStartRadius = 0.0;
 
     for (int ii = 0; ii < 3; ii++) {
         gal->Pos[ii] = (float)-99999.9;
@@ -68,10 +154,10 @@ galaxy_t* new_galaxy(int snapshot, unsigned long halo_ID)
     }
 
     for (int ii = 0; ii < N_HISTORY_SNAPS; ii++)
-        gal->NewStars[ii] = 0.0;
+        gal->Aux->NewStars[ii] = 0.0;
 
     for (int ii = 0; ii < N_HISTORY_SNAPS; ii++)
-        gal->NewMetals[ii] = 0.0;
+        gal->Aux->NewMetals[ii] = 0.0;
 
     gal->output_index = -1;
     gal->ghost_flag = false;
@@ -94,7 +180,7 @@ void copy_halo_props_to_galaxy(halo_t* halo, galaxy_t* gal)
     gal->Vvir = halo->Vvir;
     gal->TreeFlags = halo->TreeFlags;
     gal->Spin = calculate_spin_param(halo);
-    gal->FOFMvirModifier = halo->FOFGroup->FOFMvirModifier;
+    gal->FOFMvirModifier = halo_fof_group(halo)->FOFMvirModifier;
 
     double sqrt_2 = 1.414213562;
     if (gal->Type == 0) {
@@ -134,22 +220,23 @@ void reset_galaxy_properties(galaxy_t* gal, int snapshot)
     // Update the stellar mass weighted mean age values.  This only needs to be
     // done for snapshots shich are passing out of what we are able to track
     // with N_HISTORY_SNAPS.
+    galaxy_aux_t* aux = gal->Aux;
     assert(snapshot > 0);
     if (snapshot >= N_HISTORY_SNAPS) {
-        gal->mwmsa_denom += gal->NewStars[N_HISTORY_SNAPS - 1];
-        gal->mwmsa_num += gal->NewStars[N_HISTORY_SNAPS - 1] * run_globals.LTTime[snapshot - N_HISTORY_SNAPS];
+        aux->mwmsa_denom += aux->NewStars[N_HISTORY_SNAPS - 1];
+        aux->mwmsa_num += aux->NewStars[N_HISTORY_SNAPS - 1] * run_globals.LTTime[snapshot - N_HISTORY_SNAPS];
     }
 
     // roll over the baryonic history arrays
     for (int ii = N_HISTORY_SNAPS - 1; ii > 0; ii--)
-        gal->NewStars[ii] = gal->NewStars[ii - 1];
+        aux->NewStars[ii] = aux->NewStars[ii - 1];
 
     for (int ii = N_HISTORY_SNAPS - 1; ii > 0; ii--)
-        gal->NewMetals[ii] = gal->NewMetals[ii - 1];
+        aux->NewMetals[ii] = aux->NewMetals[ii - 1];
 
 
-    gal->NewStars[0] = 0.0;
-    gal->NewMetals[0] = 0.0;
+    aux->NewStars[0] = 0.0;
+    aux->NewMetals[0] = 0.0;
 }
 
 static void push_galaxy_to_halo(galaxy_t* gal, halo_t* halo)
@@ -181,6 +268,9 @@ static void push_galaxy_to_halo(galaxy_t* gal, halo_t* halo)
 
 void connect_galaxy_and_halo(galaxy_t* gal, halo_t* halo, int* merger_counter)
 {
+    // The galaxy list of this halo is changing, so any cached merger mother is
+    // no longer valid
+    halo->MergerMother = NULL;
 
     if (halo->Galaxy == NULL)
         push_galaxy_to_halo(gal, halo);
@@ -304,8 +394,8 @@ void kill_galaxy(
         }
     }
 
-    // Finally deallocated the galaxy and decrement any necessary counters
-    free(gal);
+    // Finally return the galaxy to the pool and decrement any necessary counters
+    release_galaxy(gal);
     *NGal = *NGal - 1;
     *kill_counter = *kill_counter + 1;
 }
@@ -1,6 +1,9 @@
 #include "meraxes.h"
 #include <assert.h>
 #include <gsl/gsl_integration.h>
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
 
 void init_gpu()
 {
@@ -299,6 +302,10 @@ void init_meraxes()
     // initialize GPU
     init_gpu();
 
+#ifdef USE_OPENMP
+    mlog("Evolving FOF groups with %d OpenMP threads per rank.", MLOG_MESG, omp_get_max_threads());
+#endif
+
     // initialise the random number generator
     run_globals.random_generator = gsl_rng_alloc(gsl_rng_ranlxd1);
     gsl_rng_set(run_globals.random_generator, (unsigned long)run_globals.params.RandomSeed);
@@ -330,6 +337,10 @@ void init_meraxes()
     // read in the stellar feedback tables
     read_stellar_feedback_tables();
 
+    // tabulate the pressure dependent star formation integral (if required)
+    if (run_globals.params.physics.SfPrescription == 2)
+        init_pressure_dependent_star_formation();
+
     #ifdef CALC_MAGS
     init_magnitudes();
     #endif
@@ -345,9 +356,14 @@ void init_meraxes()
     set_ReionEfficiency();
     set_quasar_fobs();
 
-    // Initialise galaxy pointers
+    // calculate the redshift dependent constants (needed when reading halos)
+    run_globals.SnapshotConsts = NULL;
+    set_snapshot_consts();
+
+    // Initialise galaxy pointers and storage
     run_globals.FirstGal = NULL;
     run_globals.LastGal = NULL;
+    init_galaxy_pool();
 
     // Set the SelectForestsSwitch
     run_globals.SelectForestsSwitch = true;
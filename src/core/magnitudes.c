@@ -8,8 +8,8 @@ enum core {MASTER};
 
 void init_luminosities(galaxy_t *gal) {
     // Initialise all elements of flux arrays to TOL.
-    double *inBCFlux = gal->inBCFlux;
-    double *outBCFlux = gal->outBCFlux;
+    double *inBCFlux = gal->Aux->inBCFlux;
+    double *outBCFlux = gal->Aux->outBCFlux;
 
     for(int iSF = 0; iSF < MAGS_N; ++iSF) {
         inBCFlux[iSF] = TOL;
@@ -39,8 +39,8 @@ void add_luminosities(
     double *pWorking = miniSpectra->working;
     double *pInBC = miniSpectra->inBC;
     double *pOutBC = miniSpectra->outBC;
-    double *pInBCFlux = gal->inBCFlux;
-    double *pOutBCFlux = gal->outBCFlux;
+    double *pInBCFlux = gal->Aux->inBCFlux;
+    double *pOutBCFlux = gal->Aux->outBCFlux;
 
     for(iS = 0; iS < MAGS_N_SNAPS; ++iS) {
         nAgeStep = miniSpectra->targetSnap[iS];
@@ -76,10 +76,10 @@ void add_luminosities(
 void merge_luminosities(galaxy_t *target, galaxy_t *gal) {
     // Sum fluexs together when a merge happens.
 
-    double *inBCFluxTgt = target->inBCFlux;
-    double *outBCFluxTgt = target->outBCFlux;
-    double *inBCFlux = gal->inBCFlux;
-    double *outBCFlux = gal->outBCFlux;
+    double *inBCFluxTgt = target->Aux->inBCFlux;
+    double *outBCFluxTgt = target->Aux->outBCFlux;
+    double *inBCFlux = gal->Aux->inBCFlux;
+    double *outBCFlux = gal->Aux->outBCFlux;
 
     for(int iSF = 0; iSF < MAGS_N; ++iSF) {
         inBCFluxTgt[iSF] += inBCFlux[iSF];
@@ -379,8 +379,8 @@ void get_output_magnitudes(float *target, galaxy_t *gal, int snapshot) {
     // Check if ``snapshot`` is a target snapshot
     int iS;
     int *targetSnap = run_globals.mag_params.targetSnap;
-    double *pInBCFlux = gal->inBCFlux;
-    double *pOutBCFlux = gal->outBCFlux;
+    double *pInBCFlux = gal->Aux->inBCFlux;
+    double *pOutBCFlux = gal->Aux->outBCFlux;
 
     for(iS = 0; iS < MAGS_N_SNAPS; ++iS) {
         if (snapshot == targetSnap[iS])
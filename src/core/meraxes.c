@@ -5,14 +5,29 @@
 
 int main(int argc, char** argv)
 {
+#if defined(USE_OPENMP) || defined(USE_FFTW_THREADS)
+    // Only the master thread makes MPI calls (outside of any parallel region or threaded FFT)
+    int mpi_thread_support;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &mpi_thread_support);
+#else
     MPI_Init(&argc, &argv);
+#endif
     MPI_Comm_dup(MPI_COMM_WORLD, &run_globals.mpi_comm);
+    run_globals.reion_comm = MPI_COMM_NULL;
     MPI_Comm_rank(MPI_COMM_WORLD, &run_globals.mpi_rank);
     MPI_Comm_size(MPI_COMM_WORLD, &run_globals.mpi_size);
 
     // init mlog
     init_mlog(MPI_COMM_WORLD, stdout, stdout, stderr);
 
+#if defined(USE_OPENMP) || defined(USE_FFTW_THREADS)
+    // N.B. This must be checked before any threads are started (including by fftwf_init_threads in `assign_slabs`)
+    if (mpi_thread_support < MPI_THREAD_FUNNELED) {
+        mlog_error("The MPI library does not support MPI_THREAD_FUNNELED (provided level = %d)!", mpi_thread_support);
+        ABORT(EXIT_FAILURE);
+    }
+#endif
+
     struct stat filestatus;
 
     // deal with any input arguments
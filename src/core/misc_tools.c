@@ -12,6 +12,43 @@ void myexit(int signum)
     exit(signum);
 }
 
+// Exit signal of an ABORT reached from within an OpenMP parallel region (see
+// ABORT in meraxes.h), or 0 if there hasn't been one.
+static int thread_abort_signum = 0;
+
+void flag_thread_abort(int signum)
+{
+    if (signum == 0)
+        signum = EXIT_FAILURE;
+
+#ifdef USE_OPENMP
+#pragma omp atomic write
+#endif
+    thread_abort_signum = signum;
+}
+
+bool thread_abort_flagged()
+{
+    int signum;
+
+#ifdef USE_OPENMP
+#pragma omp atomic read
+#endif
+    signum = thread_abort_signum;
+
+    return signum != 0;
+}
+
+// Abort the run if any thread hit an ABORT in the last parallel region.  Must
+// be called by the master thread, outside of any parallel region.
+void check_thread_abort()
+{
+    if (thread_abort_signum != 0) {
+        mlog_error("Aborting after an error on an OpenMP thread.");
+        myexit(thread_abort_signum);
+    }
+}
+
 double calc_metallicity(double total_gas, double metals)
 {
     double Z;
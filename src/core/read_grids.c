@@ -46,6 +46,9 @@ void smooth_grid(double resample_factor, int n_cell[3], fftwf_complex* slab, ptr
 {
     if (resample_factor < 1.0) {
         mlog("Smoothing hi-res grid...", MLOG_OPEN | MLOG_TIMERSTART);
+        // N.B. The file grid differs in shape from the reionization grids so
+        // we plan here rather than use the persistent plans.  Any FFTW thread
+        // count set in `assign_slabs` still applies.
         fftwf_plan plan = fftwf_mpi_plan_dft_r2c_3d(n_cell[0], n_cell[1], n_cell[2], (float*)slab, slab, run_globals.mpi_comm, FFTW_ESTIMATE);
         fftwf_execute(plan);
         fftwf_destroy_plan(plan);
@@ -69,8 +72,9 @@ void smooth_grid(double resample_factor, int n_cell[3], fftwf_complex* slab, ptr
 
 void subsample_grid(double resample_factor, int n_cell[3], int ix_hi_start, int nix_hi, float* slab_file, float* slab)
 {
-    // we don't need to do anything in this case
-    if (resample_factor >= 1.0) {
+    // we don't need to do anything in this case, unless the reionization grids
+    // only live on a subset of the ranks and so have a different decomposition
+    if ((resample_factor >= 1.0) && (run_globals.params.ReionNGridRanks == run_globals.mpi_size)) {
         memcpy(slab, slab_file, sizeof(fftwf_complex) * run_globals.reion_grids.slab_n_complex[run_globals.mpi_rank]);
         return;
     }
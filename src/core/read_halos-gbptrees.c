@@ -365,7 +365,7 @@ void read_trees__gbptrees(
                 cur_halo->SnapOffset = cur_tree_entry->file_offset;
                 cur_halo->DescIndex = cur_tree_entry->desc_index;
                 cur_halo->ProgIndex = -1;  // This information is used in the VELOCIraptor trees, but not here.
-                cur_halo->NextHaloInFOFGroup = NULL;
+                cur_halo->NextHaloInFOFGroup = -1;
 
                 if (index_lookup)
                     index_lookup[*n_halos_kept] = n_read + jj;
@@ -389,13 +389,13 @@ void read_trees__gbptrees(
                         -1,
                         snapshot);
 
-                    fof_group[(*n_fof_groups_kept)++].FirstHalo = &(halo[*n_halos_kept]);
+                    fof_group[(*n_fof_groups_kept)++].FirstHalo = *n_halos_kept;
                 } else {
                     cur_halo->Type = 1;
-                    halo[(*n_halos_kept) - 1].NextHaloInFOFGroup = &(halo[*n_halos_kept]);
+                    halo[(*n_halos_kept) - 1].NextHaloInFOFGroup = *n_halos_kept;
                 }
 
-                cur_halo->FOFGroup = &(fof_group[(*n_fof_groups_kept) - 1]);
+                cur_halo->FOFGroup = (*n_fof_groups_kept) - 1;
 
                 // paste in the halo properties
                 cur_halo->Len = cur_cat_halo->n_particles;
@@ -411,6 +411,7 @@ void read_trees__gbptrees(
                 cur_halo->AngMom[1] = cur_cat_halo->ang_mom[1];
                 cur_halo->AngMom[2] = cur_cat_halo->ang_mom[2];
                 cur_halo->Galaxy = NULL;
+                cur_halo->MergerMother = NULL;
                 cur_halo->Mvir = cur_cat_halo->M_vir;
 
                 // double check that PBC conditions are met!
@@ -243,7 +243,7 @@ void read_trees__velociraptor(int snapshot, halo_t* halos, int* n_halos, fof_gro
             else
                 halo->ProgIndex = id_to_ind(tree_entry.Tail);
 
-            halo->NextHaloInFOFGroup = NULL;
+            halo->NextHaloInFOFGroup = -1;
             halo->Type = tree_entry.hostHaloID == -1 ? 0 : 1;
             halo->SnapOffset = id_to_snap(tree_entry.Head) - snapshot;
 
@@ -274,8 +274,8 @@ void read_trees__velociraptor(int snapshot, halo_t* halos, int* n_halos, fof_gro
                 convert_input_virial_props(&fof_group->Mvir, &fof_group->Rvir, &fof_group->Vvir,
                     &fof_group->FOFMvirModifier, -1, snapshot, true);
 
-                halo->FOFGroup = &(fof_groups[*n_fof_groups]);
-                fof_groups[(*n_fof_groups)++].FirstHalo = halo;
+                halo->FOFGroup = *n_fof_groups;
+                fof_groups[(*n_fof_groups)++].FirstHalo = *n_halos;
             } else {
                 // We can take advantage of the fact that host halos always seem to appear before their subhalos in the
                 // trees to immediately connect FOF group members.
@@ -290,10 +290,10 @@ void read_trees__velociraptor(int snapshot, halo_t* halos, int* n_halos, fof_gro
                 halo_t* prev_halo = &halos[host_index];
                 halo->FOFGroup = prev_halo->FOFGroup;
 
-                while (prev_halo->NextHaloInFOFGroup != NULL)
-                    prev_halo = prev_halo->NextHaloInFOFGroup;
+                while (prev_halo->NextHaloInFOFGroup > -1)
+                    prev_halo = &halos[prev_halo->NextHaloInFOFGroup];
 
-                prev_halo->NextHaloInFOFGroup = halo;
+                prev_halo->NextHaloInFOFGroup = *n_halos;
             }
 
             halo->Len = (int)tree_entry.npart;
@@ -316,6 +316,7 @@ void read_trees__velociraptor(int snapshot, halo_t* halos, int* n_halos, fof_gro
             halo->AngMom[2] = (float)(tree_entry.Lz / tree_entry.Mass_tot);
 
             halo->Galaxy = NULL;
+            halo->MergerMother = NULL;
 
             (*n_halos)++;
         }
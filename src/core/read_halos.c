@@ -3,34 +3,14 @@
 #include <gsl/gsl_sort_int.h>
 #include <hdf5_hl.h>
 
-static void inline update_pointers_from_offsets(
-    int n_fof_groups_kept,
-    fof_group_t* fof_group,
-    const size_t* fof_FirstHalo_os,
-    int n_halos_kept,
-    halo_t* halo,
-    const size_t* halo_FOFGroup_os,
-    const size_t* halo_NextHaloInFOFGroup_os)
-{
-    for (int ii = 0; ii < n_halos_kept; ii++) {
-        halo[ii].FOFGroup = &(fof_group[halo_FOFGroup_os[ii]]);
-        if (halo_NextHaloInFOFGroup_os[ii] != (size_t)-1)
-            halo[ii].NextHaloInFOFGroup = &(halo[halo_NextHaloInFOFGroup_os[ii]]);
-        else
-            halo[ii].NextHaloInFOFGroup = NULL;
-    }
-    for (int ii = 0; ii < n_fof_groups_kept; ii++)
-        fof_group[ii].FirstHalo = &(halo[fof_FirstHalo_os[ii]]);
-}
-
 static fof_group_t* init_fof_groups()
 {
     mlog("Allocating fof_group array with %d elements...", MLOG_MESG, run_globals.NFOFGroupsMax);
     fof_group_t* fof_groups = malloc(sizeof(fof_group_t) * run_globals.NFOFGroupsMax);
 
     for (int ii = 0; ii < run_globals.NFOFGroupsMax; ii++) {
-        fof_groups[ii].FirstHalo = NULL;
-        fof_groups[ii].FirstOccupiedHalo = NULL;
+        fof_groups[ii].FirstHalo = -1;
+        fof_groups[ii].FirstOccupiedHalo = -1;
         fof_groups[ii].Mvir = 0.0;
     }
 
@@ -119,8 +99,9 @@ void initialize_halo_storage()
     // loop through and read all snapshots
     if (run_globals.params.FlagInteractive || run_globals.params.FlagMCMC) {
         mlog("Preloading input trees and halos...", MLOG_OPEN);
-        for (int i_snap = 0; i_snap <= last_snap; i_snap++)
+        for (int i_snap = 0; i_snap <= last_snap; i_snap++) {
             read_halos(i_snap, &((*snapshot_halo)[i_snap]), &((*snapshot_fof_group)[i_snap]), &((*snapshot_index_lookup)[i_snap]), *snapshot_trees_info);
+        }
         mlog("...done", MLOG_CLOSE);
     }
 
@@ -496,35 +477,8 @@ trees_info_t read_halos(const int snapshot, halo_t** halos, fof_group_t** fof_gr
 
     // if we are doing multiple runs then resize the arrays to save space and store the trees_info
     if (run_globals.params.FlagInteractive || run_globals.params.FlagMCMC) {
-        // Ok - what follows here is hacky as hell.  By calling realloc on these
-        // arrays, there is a good chance that the actual array will be moved and
-        // there is no way to prevent this.  A side effect will be that all of the
-        // pointers that refer to any of these arrays will be broken.  The simplest
-        // way to deal with this is to calculate the array offsets which each
-        // pointer refers to, and then reset all of the pointers in the realloc'd
-        // arrays.
-        //
-        // In future, this should definitely be changed. All pointers to these
-        // array members should be made integer offsets instead.  That will require
-        // trawling through the code and making the relevant updates in a number of
-        // places (so we'll leave that till later!).
-
-        mlog("Calculating pointer offsets...", MLOG_MESG);
-
-        size_t* halo_FOFGroup_os = malloc(sizeof(size_t) * n_halos);
-        size_t* halo_NextHaloInFOFGroup_os = malloc(sizeof(size_t) * n_halos);
-        size_t* fof_FirstHalo_os = malloc(sizeof(size_t) * n_fof_groups);
-
-        for (int ii = 0; ii < n_halos; ii++) {
-            halo_FOFGroup_os[ii] = (size_t)((*halos)[ii].FOFGroup - (*fof_groups));
-            if ((*halos)[ii].NextHaloInFOFGroup != NULL)
-                halo_NextHaloInFOFGroup_os[ii] = (size_t)((*halos)[ii].NextHaloInFOFGroup - (*halos));
-            else
-                halo_NextHaloInFOFGroup_os[ii] = (size_t)-1;
-        }
-        for (int ii = 0; ii < n_fof_groups; ii++)
-            fof_FirstHalo_os[ii] = (size_t)((*fof_groups)[ii].FirstHalo - (*halos));
-
+        // N.B. All halo and FOF group links are stored as array indices, so
+        // nothing needs to be fixed up if realloc moves these arrays.
         mlog("Reallocing halo storage arrays...", MLOG_OPEN);
 
         *halos = (halo_t*)realloc(*halos, sizeof(halo_t) * n_halos);
@@ -534,17 +488,11 @@ trees_info_t read_halos(const int snapshot, halo_t** halos, fof_group_t** fof_gr
         // or we are subsampling the trees).
         if (*index_lookup)
             *index_lookup = (int*)realloc(*index_lookup, sizeof(int) * n_halos);
-        update_pointers_from_offsets(n_fof_groups, *fof_groups, fof_FirstHalo_os,
-            n_halos, *halos, halo_FOFGroup_os, halo_NextHaloInFOFGroup_os);
 
         // save the trees_info for this snapshot as well...
         snapshot_trees_info[snapshot] = trees_info;
 
         mlog(" ...done (resized to %d halos on rank=0)", MLOG_CLOSE, n_halos);
-
-        free(fof_FirstHalo_os);
-        free(halo_NextHaloInFOFGroup_os);
-        free(halo_FOFGroup_os);
     }
 
     MPI_Allreduce(MPI_IN_PLACE, &n_halos, 1, MPI_INT, MPI_SUM, run_globals.mpi_comm);
@@ -12,6 +12,17 @@ static void check_problem_params(run_params_t* run_params)
         mlog_error("The current version of the code only works if Flag_SeparateQSOXrays = 0. Sorry! Exiting...");
         ABORT(EXIT_FAILURE);
     }
+
+    if (run_params->ReionFFTWNThreads < 1) {
+        mlog_error("ReionFFTWNThreads must be >= 1 (got %d).", run_params->ReionFFTWNThreads);
+        ABORT(EXIT_FAILURE);
+    }
+
+    // The tabulated frequencies span the nu_tau_one bracket, which needs at least two points
+    if ((run_params->TsTauXTableNNu != 0) && (run_params->TsTauXTableNNu < 2)) {
+        mlog_error("TsTauXTableNNu must be 0 (off) or >= 2 (got %d).", run_params->TsTauXTableNNu);
+        ABORT(EXIT_FAILURE);
+    }
 }
 
 static void store_params(entry_t entry[123],
@@ -768,6 +779,48 @@ void read_parameter_file(char* fname, int mode)
             required_tag[n_param] = 1;
             params_type[n_param++] = PARAM_TYPE_INT;
 
+            strncpy(params_tag[n_param], "ReionFFTWPlannerRigor", tag_length);
+            params_addr[n_param] = &(run_params->ReionFFTWPlannerRigor);
+            required_tag[n_param] = 0;
+            params_type[n_param++] = PARAM_TYPE_INT;
+            run_params->ReionFFTWPlannerRigor = 0;
+
+            strncpy(params_tag[n_param], "ReionFFTWNThreads", tag_length);
+            params_addr[n_param] = &(run_params->ReionFFTWNThreads);
+            required_tag[n_param] = 0;
+            params_type[n_param++] = PARAM_TYPE_INT;
+            run_params->ReionFFTWNThreads = 1;
+
+            strncpy(params_tag[n_param], "ReionLeanMemory", tag_length);
+            params_addr[n_param] = &(run_params->ReionLeanMemory);
+            required_tag[n_param] = 0;
+            params_type[n_param++] = PARAM_TYPE_INT;
+            run_params->ReionLeanMemory = 0;
+
+            strncpy(params_tag[n_param], "ReionNGridRanks", tag_length);
+            params_addr[n_param] = &(run_params->ReionNGridRanks);
+            required_tag[n_param] = 0;
+            params_type[n_param++] = PARAM_TYPE_INT;
+            run_params->ReionNGridRanks = 0;
+
+            strncpy(params_tag[n_param], "Flag_CacheXHeatingTables", tag_length);
+            params_addr[n_param] = &(run_params->Flag_CacheXHeatingTables);
+            required_tag[n_param] = 0;
+            params_type[n_param++] = PARAM_TYPE_INT;
+            run_params->Flag_CacheXHeatingTables = 0;
+
+            strncpy(params_tag[n_param], "TsFloatSmoothedSFR", tag_length);
+            params_addr[n_param] = &(run_params->TsFloatSmoothedSFR);
+            required_tag[n_param] = 0;
+            params_type[n_param++] = PARAM_TYPE_INT;
+            run_params->TsFloatSmoothedSFR = 0;
+
+            strncpy(params_tag[n_param], "TsTauXTableNNu", tag_length);
+            params_addr[n_param] = &(run_params->TsTauXTableNNu);
+            required_tag[n_param] = 0;
+            params_type[n_param++] = PARAM_TYPE_INT;
+            run_params->TsTauXTableNNu = 0;
+
             strncpy(params_tag[n_param], "TsHeatingFilterType", tag_length);
             params_addr[n_param] = &(run_params->TsHeatingFilterType);
             required_tag[n_param] = 1;
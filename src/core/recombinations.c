@@ -47,8 +47,9 @@ static gsl_spline *beta_spline;
 #define RR_lnGamma_min (double) (-10) // min ln gamma12 used
 #define RR_DEL_lnGamma (float) (0.1)
 static double RR_table[RR_Z_NPTS][RR_lnGamma_NPTS], lnGamma_values[RR_lnGamma_NPTS];
-static gsl_interp_accel *RR_acc[RR_Z_NPTS];
-static gsl_spline *RR_spline[RR_Z_NPTS];
+// natural cubic spline coefficients in gamma for each interval of each redshift (y, b, c, d)
+static double RR_coeffs[RR_Z_NPTS][RR_lnGamma_NPTS - 1][4];
+static bool RR_initialised = false;
 
 
 //double alpha_A(double T);
@@ -96,7 +97,50 @@ double splined_recombination_rate(double z_eff, double gamma12_bg){
         lnGamma =  RR_lnGamma_min + RR_DEL_lnGamma * RR_lnGamma_NPTS - FRACT_FLOAT_ERR;
     }
 
-    return gsl_spline_eval(RR_spline[z_ct], lnGamma, RR_acc[z_ct]);
+    // The gamma axis is uniform so we can index the interval directly
+    int gamma_ct = (int)((lnGamma - RR_lnGamma_min) / RR_DEL_lnGamma);
+    if (gamma_ct > RR_lnGamma_NPTS - 2)
+        gamma_ct = RR_lnGamma_NPTS - 2;
+
+    const double* coeffs = RR_coeffs[z_ct][gamma_ct];
+    double dx = lnGamma - lnGamma_values[gamma_ct];
+
+    return coeffs[0] + dx * (coeffs[1] + dx * (coeffs[2] + dx * coeffs[3]));
+}
+
+static void tabulate_RR_spline(int z_ct)
+{
+    // Natural cubic spline through RR_table[z_ct] (the same interpolant as
+    // gsl_interp_cspline), stored as per-interval polynomial coefficients
+    // so that it can be evaluated without any GSL bookkeeping.
+    const int n_knots = RR_lnGamma_NPTS;
+    const double* x = lnGamma_values;
+    const double* y = RR_table[z_ct];
+    double c[RR_lnGamma_NPTS], diag[RR_lnGamma_NPTS], rhs[RR_lnGamma_NPTS];
+
+    // solve the tridiagonal system for the interior knots (Thomas algorithm)
+    c[0] = c[n_knots - 1] = 0.0;
+    for (int ii = 1; ii < n_knots - 1; ii++) {
+        double h_lo = x[ii] - x[ii - 1];
+        double h_hi = x[ii + 1] - x[ii];
+        diag[ii] = 2.0 * (h_lo + h_hi);
+        rhs[ii] = 3.0 * ((y[ii + 1] - y[ii]) / h_hi - (y[ii] - y[ii - 1]) / h_lo);
+        if (ii > 1) {
+            double w = h_lo / diag[ii - 1];
+            diag[ii] -= w * h_lo;
+            rhs[ii] -= w * rhs[ii - 1];
+        }
+    }
+    for (int ii = n_knots - 2; ii > 0; ii--)
+        c[ii] = (rhs[ii] - (x[ii + 1] - x[ii]) * c[ii + 1]) / diag[ii];
+
+    for (int ii = 0; ii < n_knots - 1; ii++) {
+        double h = x[ii + 1] - x[ii];
+        RR_coeffs[z_ct][ii][0] = y[ii];
+        RR_coeffs[z_ct][ii][1] = (y[ii + 1] - y[ii]) / h - h * (c[ii + 1] + 2.0 * c[ii]) / 3.0;
+        RR_coeffs[z_ct][ii][2] = c[ii];
+        RR_coeffs[z_ct][ii][3] = (c[ii + 1] - c[ii]) / (3.0 * h);
+    }
 }
 
 
@@ -105,6 +149,12 @@ void init_MHR(){
     int z_ct, gamma_ct;
     float z, gamma;
 
+    // The tables only depend on the cosmology so they are built once per run
+    if (RR_initialised)
+        return;
+
+    mlog("Tabulating MHR00 recombination rates...", MLOG_OPEN | MLOG_TIMERSTART);
+
     // first initialize the MHR parameter look up tables
     init_C_MHR(); /*initializes the lookup table for the C paremeter in MHR00 model*/
     init_beta_MHR(); /*initializes the lookup table for the beta paremeter in MHR00 model*/
@@ -123,27 +173,26 @@ void init_MHR(){
         }
 
         // set up the spline in gamma
-        RR_acc[z_ct] = gsl_interp_accel_alloc();
-        RR_spline[z_ct] = gsl_spline_alloc(gsl_interp_cspline, RR_lnGamma_NPTS);
-        gsl_spline_init(RR_spline[z_ct], lnGamma_values, RR_table[z_ct], RR_lnGamma_NPTS);
+        tabulate_RR_spline(z_ct);
 
     } // go to next redshift
+
+    RR_initialised = true;
+
+    mlog("...done", MLOG_CLOSE | MLOG_TIMERSTOP);
 }
 
 
 
 void free_MHR(){
-    int z_ct;
+    if (!RR_initialised)
+        return;
 
     free_A_MHR();
     free_C_MHR();
     free_beta_MHR();
 
-    // now the recombination rate look up tables
-    for (z_ct=0; z_ct < RR_Z_NPTS; z_ct++){
-        gsl_spline_free (RR_spline[z_ct]);
-        gsl_interp_accel_free(RR_acc[z_ct]);
-    }
+    RR_initialised = false;
 }
 
 //calculates the attenuated photoionization rate due to self-shielding (in units of 1e-12 s^-1)
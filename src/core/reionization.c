@@ -8,14 +8,16 @@ void update_galaxy_fesc_vals(galaxy_t* gal, double new_stars, int snapshot)
 {
     physics_params_t* params = &(run_globals.params.physics);
 
-    float fesc_bh = (float)(params->EscapeFracBHNorm * (powf((float)((1.0 + run_globals.ZZ[snapshot]) / 6.0), (float)params->EscapeFracBHScaling)));
+    const snapshot_consts_t* consts = get_snapshot_consts(snapshot);
+
+    float fesc_bh = consts->EscapeFracBH;
 
     double fesc = params->EscapeFracNorm;
 
     // redshift
     if ((params->EscapeFracDependency > 0) && (params->EscapeFracDependency <= 6))
         if (params->EscapeFracRedshiftScaling != 0.0)
-            fesc *= pow((1.0 + run_globals.ZZ[snapshot]) / 6.0, params->EscapeFracRedshiftScaling);
+            fesc *= consts->EscapeFracZScaling;
 
     // galaxy properties
     switch (params->EscapeFracDependency) {
@@ -114,15 +116,46 @@ void assign_slabs()
     mlog("Assigning slabs to MPI cores...", MLOG_OPEN);
 
     // Allocations made in this function are free'd in `free_reionization_grids`.
+#ifdef USE_FFTW_THREADS
+    // N.B. This must be called before fftwf_mpi_init and the thread count
+    // applies to every plan created from here on.
+    if (!fftwf_init_threads()) {
+        mlog_error("Failed to initialise FFTW threads!");
+        ABORT(EXIT_FAILURE);
+    }
     fftwf_mpi_init();
+    fftwf_plan_with_nthreads(run_globals.params.ReionFFTWNThreads);
+    mlog("Using %d FFTW threads per rank.", MLOG_MESG, run_globals.params.ReionFFTWNThreads);
+#else
+    fftwf_mpi_init();
+    if (run_globals.params.ReionFFTWNThreads > 1)
+        mlog("ReionFFTWNThreads = %d ignored (not compiled with USE_FFTW_THREADS).", MLOG_MESG, run_globals.params.ReionFFTWNThreads);
+#endif
 
     // Assign the slab size
     int n_rank = run_globals.mpi_size;
     int dim = run_globals.params.ReionGridDim;
 
+    // The grids (and the FFT transposes) live on the first ReionNGridRanks
+    // ranks only.  The remaining ranks still evolve galaxies, depositing
+    // into and reading back from the grid ranks through the usual
+    // galaxy_to_slab_map, but hold an empty slab.
+    int n_grid_ranks = run_globals.params.ReionNGridRanks;
+    if ((n_grid_ranks <= 0) || (n_grid_ranks > n_rank))
+        n_grid_ranks = n_rank;
+    run_globals.params.ReionNGridRanks = n_grid_ranks;
+    if (n_grid_ranks < n_rank)
+        mlog("Reionization grids distributed over %d of %d ranks.", MLOG_MESG, n_grid_ranks, n_rank);
+
+    int color = (run_globals.mpi_rank < n_grid_ranks) ? 0 : MPI_UNDEFINED;
+    MPI_Comm_split(run_globals.mpi_comm, color, run_globals.mpi_rank, &run_globals.reion_comm);
+
     // Use fftw to find out what slab each rank should get
-    ptrdiff_t local_nix, local_ix_start;
-    ptrdiff_t local_n_complex = fftwf_mpi_local_size_3d(dim, dim, dim / 2 + 1, run_globals.mpi_comm, &local_nix, &local_ix_start);
+    ptrdiff_t local_nix = 0;
+    ptrdiff_t local_ix_start = dim;
+    ptrdiff_t local_n_complex = 0;
+    if (run_globals.reion_comm != MPI_COMM_NULL)
+        local_n_complex = fftwf_mpi_local_size_3d(dim, dim, dim / 2 + 1, run_globals.reion_comm, &local_nix, &local_ix_start);
 
     // let every core know...
     ptrdiff_t** slab_nix = &run_globals.reion_grids.slab_nix;
@@ -142,6 +175,120 @@ void assign_slabs()
     mlog("...done", MLOG_CLOSE);
 }
 
+static unsigned reion_fftw_planner_flag()
+{
+    switch (run_globals.params.ReionFFTWPlannerRigor) {
+        case 0:
+            return FFTW_ESTIMATE;
+        case 1:
+            return FFTW_MEASURE;
+        case 2:
+            return FFTW_PATIENT;
+        default:
+            mlog_error("Unrecognised ReionFFTWPlannerRigor (%d)!", run_globals.params.ReionFFTWPlannerRigor);
+            ABORT(EXIT_FAILURE);
+    }
+
+    return FFTW_ESTIMATE;
+}
+
+void create_reion_fftw_plans()
+{
+    // The r2c and c2r transforms of the reionization grids all act in-place
+    // on fftwf_alloc'd slabs of the same shape, so a single pair of plans can
+    // be executed on any of them via the new-array execute interface.  These
+    // must be created before the grids are initialised as any planner rigor
+    // other than FFTW_ESTIMATE will overwrite the arrays used for planning.
+
+    unsigned flag = reion_fftw_planner_flag();
+    int ReionGridDim = run_globals.params.ReionGridDim;
+    reion_grids_t* grids = &(run_globals.reion_grids);
+    char fname[STRLEN + 64];
+
+    // Ranks outside the reionization sub-communicator never execute the plans
+    if (run_globals.reion_comm == MPI_COMM_NULL) {
+        grids->r2c_plan = NULL;
+        grids->c2r_plan = NULL;
+        grids->c2r_many_plan = NULL;
+        return;
+    }
+
+    int n_grid_ranks;
+    MPI_Comm_size(run_globals.reion_comm, &n_grid_ranks);
+
+    mlog("Creating reionization FFTW plans...", MLOG_OPEN | MLOG_TIMERSTART);
+
+    // In lean memory mode the working buffers are only allocated while they are needed
+    if (run_globals.params.ReionLeanMemory)
+        malloc_find_HII_bubbles_buffers();
+
+    // Wisdom is only useful for the same grid and rank count, so we keep one file per rank count
+    sprintf(fname, "%s/fftwf_wisdom-np%d.dat", run_globals.params.OutputDir, n_grid_ranks);
+
+    if (flag != FFTW_ESTIMATE) {
+        if (run_globals.mpi_rank == 0) {
+            if (fftwf_import_wisdom_from_filename(fname))
+                mlog("Imported FFTW wisdom from %s", MLOG_MESG, fname);
+        }
+        fftwf_mpi_broadcast_wisdom(run_globals.reion_comm);
+    }
+
+    // N.B. deltax_temp isn't allocated in lean memory mode, but sfr_temp always is
+    float* r2c_buffer = run_globals.params.ReionLeanMemory ? grids->sfr_temp : grids->deltax_temp;
+    grids->r2c_plan = fftwf_mpi_plan_dft_r2c_3d(ReionGridDim, ReionGridDim, ReionGridDim,
+        r2c_buffer, (fftwf_complex*)r2c_buffer, run_globals.reion_comm, flag);
+    grids->c2r_plan = fftwf_mpi_plan_dft_c2r_3d(ReionGridDim, ReionGridDim, ReionGridDim,
+        grids->sfr_filtered, (float*)grids->sfr_filtered, run_globals.reion_comm, flag);
+
+    // All of the filtered fields are inverse transformed together, amortising the MPI transposes
+    ptrdiff_t n_real[3] = { ReionGridDim, ReionGridDim, ReionGridDim };
+    grids->c2r_many_plan = fftwf_mpi_plan_many_dft_c2r(3, n_real, grids->n_filtered_fields,
+        FFTW_MPI_DEFAULT_BLOCK, FFTW_MPI_DEFAULT_BLOCK, grids->filtered_fields, (float*)grids->filtered_fields,
+        run_globals.reion_comm, flag);
+
+    if ((grids->r2c_plan == NULL) || (grids->c2r_plan == NULL) || (grids->c2r_many_plan == NULL)) {
+        mlog_error("Failed to create reionization FFTW plans!");
+        ABORT(EXIT_FAILURE);
+    }
+
+    if (flag != FFTW_ESTIMATE) {
+        fftwf_mpi_gather_wisdom(run_globals.reion_comm);
+        if (run_globals.mpi_rank == 0) {
+            if (!fftwf_export_wisdom_to_filename(fname))
+                mlog("Failed to export FFTW wisdom to %s", MLOG_MESG, fname);
+        }
+    }
+
+    if (run_globals.params.ReionLeanMemory)
+        free_find_HII_bubbles_buffers();
+
+    mlog("...done", MLOG_CLOSE | MLOG_TIMERSTOP);
+}
+
+void destroy_reion_fftw_plans()
+{
+    if (run_globals.reion_comm == MPI_COMM_NULL)
+        return;
+
+    fftwf_destroy_plan(run_globals.reion_grids.r2c_plan);
+    fftwf_destroy_plan(run_globals.reion_grids.c2r_plan);
+    fftwf_destroy_plan(run_globals.reion_grids.c2r_many_plan);
+}
+
+void reion_fftw_execute_r2c(fftwf_plan plan, float* in, fftwf_complex* out)
+{
+    // Ranks outside the reionization sub-communicator hold no cells and take
+    // no part in the transforms, but otherwise follow the same code path.
+    if (run_globals.reion_comm != MPI_COMM_NULL)
+        fftwf_mpi_execute_dft_r2c(plan, in, out);
+}
+
+void reion_fftw_execute_c2r(fftwf_plan plan, fftwf_complex* in, float* out)
+{
+    if (run_globals.reion_comm != MPI_COMM_NULL)
+        fftwf_mpi_execute_dft_c2r(plan, in, out);
+}
+
 void call_find_HII_bubbles(int snapshot, int nout_gals, timer_info* timer)
 {
     // Thin wrapper round find_HII_bubbles
@@ -236,11 +383,6 @@ void init_reion_grids()
     ptrdiff_t slab_n_real = slab_nix[run_globals.mpi_rank] * ReionGridDim * ReionGridDim; // TODO: NOT WORKING!!!
     ptrdiff_t slab_n_complex = run_globals.reion_grids.slab_n_complex[run_globals.mpi_rank];
 
-    ptrdiff_t slab_n_real_smoothedSFR;
-    if(run_globals.params.Flag_IncludeSpinTemp) {
-        slab_n_real_smoothedSFR = slab_nix[run_globals.mpi_rank] * run_globals.params.TsNumFilterSteps  * ReionGridDim * ReionGridDim;
-    }
-
     ptrdiff_t slab_n_real_LC;
     if(run_globals.params.Flag_ConstructLightcone) {
         slab_n_real_LC = slab_nix[run_globals.mpi_rank] * ReionGridDim * run_globals.params.LightconeLength;
@@ -282,17 +424,6 @@ void init_reion_grids()
         }
     }
 
-    if(run_globals.params.Flag_IncludeSpinTemp) {
-
-        for (int ii = 0; ii < slab_n_real_smoothedSFR; ii++) {
-            grids->SMOOTHED_SFR_GAL[ii] = 0.0;
-
-            if(run_globals.params.Flag_SeparateQSOXrays) {
-                grids->SMOOTHED_SFR_QSO[ii] = 0.0;
-            }
-        }
-
-    }
 
 
     if(run_globals.params.Flag_ConstructLightcone) {
@@ -313,14 +444,14 @@ void init_reion_grids()
         }
 
     for (int ii = 0; ii < slab_n_complex; ii++) {
+#ifdef USE_CUDA
         grids->stars_filtered[ii] = 0 + 0I;
         grids->deltax_filtered[ii] = 0 + 0I;
+#endif
         grids->sfr_filtered[ii] = 0 + 0I;
-        if(run_globals.params.Flag_IncludeSpinTemp) {
-            grids->x_e_filtered[ii] = 0 + 0I;
-        }
-        if(run_globals.params.Flag_IncludeRecombinations) {
-            grids->N_rec_filtered[ii] = 0 + 0I;
+        if (!run_globals.params.ReionLeanMemory) {
+            for (int jj = 0; jj < grids->n_filtered_fields; jj++)
+                grids->filtered_fields[(ptrdiff_t)ii * grids->n_filtered_fields + jj] = 0 + 0I;
         }
         if(run_globals.params.Flag_Compute21cmBrightTemp&&(run_globals.params.Flag_IncludePecVelsFor21cm > 0)) {
             grids->vel_gradient[ii] = 0 + 0I;
@@ -334,8 +465,10 @@ void init_reion_grids()
         grids->sfr[ii] = 0;
 
         // Include temporary arrays to return to original data (as FFT modifies the result)
-        grids->deltax_temp[ii] = 0;
-        grids->stars_temp[ii] = 0;
+        if (!run_globals.params.ReionLeanMemory) {
+            grids->deltax_temp[ii] = 0;
+            grids->stars_temp[ii] = 0;
+        }
         grids->sfr_temp[ii] = 0;
 
         if(run_globals.params.Flag_IncludeSpinTemp) {
@@ -344,7 +477,8 @@ void init_reion_grids()
         }
         if(run_globals.params.Flag_IncludeRecombinations) {
             grids->N_rec[ii] = 0;
-            grids->N_rec_prev[ii] = 0;
+            if (!run_globals.params.ReionLeanMemory)
+                grids->N_rec_prev[ii] = 0;
         }
         if(run_globals.params.Flag_Compute21cmBrightTemp&&(run_globals.params.Flag_IncludePecVelsFor21cm > 0)) {
             grids->vel[ii] = 0;
@@ -362,6 +496,105 @@ void init_reion_grids()
 
 }
 
+size_t malloc_find_HII_bubbles_buffers()
+{
+    // The k-space working copies of the input grids and the interleaved
+    // filtered fields used by `_find_HII_bubbles`.  These are resident for the
+    // whole run by default.  When ReionLeanMemory is set they are only
+    // allocated for the duration of each call, and deltax, stars and sfr are
+    // transformed without a copy of their own (see `_find_HII_bubbles`), so
+    // only N_rec and the filtered fields are needed.
+    //
+    // Returns the number of bytes allocated.
+    reion_grids_t* grids = &(run_globals.reion_grids);
+    int ReionGridDim = run_globals.params.ReionGridDim;
+    ptrdiff_t slab_n_complex = grids->slab_n_complex[run_globals.mpi_rank];
+    bool lean_memory = run_globals.params.ReionLeanMemory;
+    size_t slab_bytes = sizeof(fftwf_complex) * (size_t)slab_n_complex;
+    size_t n_bytes = 0;
+
+    if (!lean_memory) {
+        grids->deltax_temp = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
+        grids->stars_temp = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
+        n_bytes += 2 * slab_bytes;
+    }
+    if (run_globals.params.Flag_IncludeRecombinations) {
+        grids->N_rec_prev = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
+        n_bytes += slab_bytes;
+    }
+
+    // Same slab decomposition as `assign_slabs`, but for the interleaved fields
+    ptrdiff_t fields_n_complex[3] = { ReionGridDim, ReionGridDim, ReionGridDim / 2 + 1 };
+    ptrdiff_t fields_nix = 0, fields_ix_start = ReionGridDim;
+    ptrdiff_t fields_n_alloc = 0;
+    if (run_globals.reion_comm != MPI_COMM_NULL)
+        fields_n_alloc = fftwf_mpi_local_size_many(3, fields_n_complex, grids->n_filtered_fields,
+            FFTW_MPI_DEFAULT_BLOCK, run_globals.reion_comm, &fields_nix, &fields_ix_start);
+    assert(fields_nix == grids->slab_nix[run_globals.mpi_rank]);
+    grids->filtered_fields = fftwf_alloc_complex((size_t)fields_n_alloc);
+    n_bytes += sizeof(fftwf_complex) * (size_t)fields_n_alloc;
+
+    if ((grids->filtered_fields == NULL)
+        || (!lean_memory && ((grids->deltax_temp == NULL) || (grids->stars_temp == NULL)))
+        || (run_globals.params.Flag_IncludeRecombinations && (grids->N_rec_prev == NULL))) {
+        mlog_error("Failed to allocate find_HII_bubbles working buffers!");
+        ABORT(EXIT_FAILURE);
+    }
+
+    grids->find_HII_bubbles_buffer_bytes = n_bytes;
+
+    return n_bytes;
+}
+
+void free_find_HII_bubbles_buffers()
+{
+    reion_grids_t* grids = &(run_globals.reion_grids);
+
+    fftwf_free(grids->filtered_fields);
+    fftwf_free(grids->N_rec_prev);
+    fftwf_free(grids->stars_temp);
+    fftwf_free(grids->deltax_temp);
+
+    grids->filtered_fields = NULL;
+    grids->N_rec_prev = NULL;
+    grids->stars_temp = NULL;
+    grids->deltax_temp = NULL;
+}
+
+void malloc_smoothed_sfr_grids()
+{
+    // The smoothed SFR at every filter step used by `_ComputeTs`.  At
+    // TsNumFilterSteps values per cell this is by far the largest of the
+    // reionization grids, so it can be stored in single precision
+    // (TsFloatSmoothedSFR) and, like the find_HII_bubbles buffers, is only
+    // allocated while ComputeTs runs when ReionLeanMemory is set.
+    reion_grids_t* grids = &(run_globals.reion_grids);
+    int ReionGridDim = run_globals.params.ReionGridDim;
+    size_t n_cells = (size_t)grids->slab_nix[run_globals.mpi_rank] * run_globals.params.TsNumFilterSteps * ReionGridDim * ReionGridDim;
+    size_t elem_size = run_globals.params.TsFloatSmoothedSFR ? sizeof(float) : sizeof(double);
+
+    grids->SMOOTHED_SFR_GAL = calloc(n_cells, elem_size);
+    if (run_globals.params.Flag_SeparateQSOXrays)
+        grids->SMOOTHED_SFR_QSO = calloc(n_cells, elem_size);
+
+    if ((n_cells > 0) && ((grids->SMOOTHED_SFR_GAL == NULL)
+                             || (run_globals.params.Flag_SeparateQSOXrays && (grids->SMOOTHED_SFR_QSO == NULL)))) {
+        mlog_error("Failed to allocate the smoothed SFR grids!");
+        ABORT(EXIT_FAILURE);
+    }
+}
+
+void free_smoothed_sfr_grids()
+{
+    reion_grids_t* grids = &(run_globals.reion_grids);
+
+    free(grids->SMOOTHED_SFR_QSO);
+    free(grids->SMOOTHED_SFR_GAL);
+
+    grids->SMOOTHED_SFR_QSO = NULL;
+    grids->SMOOTHED_SFR_GAL = NULL;
+}
+
 void malloc_reionization_grids()
 {
     reion_grids_t* grids = &(run_globals.reion_grids);
@@ -385,6 +618,10 @@ void malloc_reionization_grids()
     grids->sfr_temp = NULL;
     grids->sfr_unfiltered = NULL;
     grids->sfr_filtered = NULL;
+    grids->filtered_fields = NULL;
+    grids->n_filtered_fields = 0;
+    grids->filter_kernel = (filter_kernel_t){ 0 };
+    grids->find_HII_bubbles_buffer_bytes = 0;
     grids->z_at_ionization = NULL;
     grids->J_21_at_ionization = NULL;
     grids->J_21 = NULL;
@@ -395,7 +632,6 @@ void malloc_reionization_grids()
     grids->Tk_box = NULL;
     grids->TS_box = NULL;
     grids->x_e_unfiltered = NULL;
-    grids->x_e_filtered = NULL;
 
     grids->SMOOTHED_SFR_GAL = NULL;
     grids->SMOOTHED_SFR_QSO = NULL;
@@ -403,7 +639,6 @@ void malloc_reionization_grids()
 
     // Grids required for inhomogeneous recombinations
     grids->N_rec_unfiltered = NULL;
-    grids->N_rec_filtered = NULL;
     grids->z_re = NULL;
     grids->Gamma12 = NULL;
     grids->N_rec = NULL;
@@ -434,11 +669,6 @@ void malloc_reionization_grids()
         ptrdiff_t slab_n_real = slab_nix[run_globals.mpi_rank] * ReionGridDim * ReionGridDim; // TODO: NOT WORKING!!!
         ptrdiff_t slab_n_complex = run_globals.reion_grids.slab_n_complex[run_globals.mpi_rank];
 
-        ptrdiff_t slab_n_real_smoothedSFR;
-        if(run_globals.params.Flag_IncludeSpinTemp) {
-            slab_n_real_smoothedSFR = slab_nix[run_globals.mpi_rank] * run_globals.params.TsNumFilterSteps  * ReionGridDim * ReionGridDim;
-        }
-
         ptrdiff_t slab_n_real_LC;
         if(run_globals.params.Flag_ConstructLightcone) {
             slab_n_real_LC = slab_nix[run_globals.mpi_rank] * ReionGridDim * run_globals.params.LightconeLength;
@@ -456,14 +686,25 @@ void malloc_reionization_grids()
 
         grids->buffer = fftwf_alloc_real((size_t)max_cells);
         grids->stars = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
-        grids->stars_temp = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
-        grids->stars_filtered = fftwf_alloc_complex((size_t)slab_n_complex);
         grids->deltax = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
-        grids->deltax_temp = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
+#ifdef USE_CUDA
+        // The CPU version of find_HII_bubbles uses `filtered_fields` instead
+        grids->stars_filtered = fftwf_alloc_complex((size_t)slab_n_complex);
         grids->deltax_filtered = fftwf_alloc_complex((size_t)slab_n_complex);
+#endif
         grids->sfr = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
         grids->sfr_temp = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
         grids->sfr_filtered = fftwf_alloc_complex((size_t)slab_n_complex);
+
+        grids->n_filtered_fields = 3;
+        if (run_globals.params.Flag_IncludeRecombinations)
+            grids->n_filtered_fields++;
+        if (run_globals.params.Flag_IncludeSpinTemp)
+            grids->n_filtered_fields++;
+
+        if (!run_globals.params.ReionLeanMemory)
+            malloc_find_HII_bubbles_buffers();
+
         grids->xH = fftwf_alloc_real((size_t)slab_n_real);
         grids->z_at_ionization = fftwf_alloc_real((size_t)slab_n_real);
         grids->r_bubble = fftwf_alloc_real((size_t)slab_n_real);
@@ -475,18 +716,12 @@ void malloc_reionization_grids()
             grids->Tk_box = fftwf_alloc_real((size_t)slab_n_real);
             grids->TS_box = fftwf_alloc_real((size_t)slab_n_real);
 
-            grids->x_e_filtered = fftwf_alloc_complex((size_t)slab_n_complex);
-
-            grids->SMOOTHED_SFR_GAL = calloc((size_t)slab_n_real_smoothedSFR, sizeof(double));
-            if(run_globals.params.Flag_SeparateQSOXrays) {
-                grids->SMOOTHED_SFR_QSO = calloc((size_t)slab_n_real_smoothedSFR, sizeof(double));
-            }
+            if (!run_globals.params.ReionLeanMemory)
+                malloc_smoothed_sfr_grids();
         }
 
         if(run_globals.params.Flag_IncludeRecombinations) {
             grids->N_rec = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
-            grids->N_rec_prev = fftwf_alloc_real((size_t)slab_n_complex * 2); // padded for in-place FFT
-            grids->N_rec_filtered = fftwf_alloc_complex((size_t)slab_n_complex);
 
             grids->z_re = fftwf_alloc_real((size_t)slab_n_real);
             grids->Gamma12 = fftwf_alloc_real((size_t)slab_n_real);
@@ -523,7 +758,16 @@ void malloc_reionization_grids()
             grids->PS_error = fftwf_alloc_real((size_t)run_globals.params.PS_Length);
         }
 
+        create_reion_fftw_plans();
         init_reion_grids();
+
+        // The recombination rate tables are independent of the snapshot so we build them once here
+        if (run_globals.params.Flag_IncludeRecombinations)
+            init_MHR();
+
+        // Likewise for the X-ray heating / spin temperature tables
+        if (run_globals.params.Flag_IncludeSpinTemp)
+            init_heat_tables();
     }
 }
 
@@ -533,10 +777,17 @@ void free_reionization_grids()
 
     reion_grids_t* grids = &(run_globals.reion_grids);
 
+    destroy_reion_fftw_plans();
+    if (!run_globals.params.ReionLeanMemory)
+        free_find_HII_bubbles_buffers();
+
     free(run_globals.reion_grids.slab_n_complex);
     free(run_globals.reion_grids.slab_ix_start);
     free(run_globals.reion_grids.slab_nix);
 
+    if (run_globals.reion_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&run_globals.reion_comm);
+
     if (run_globals.params.ReionUVBFlag) {
         fftwf_free(grids->J_21);
         fftwf_free(grids->J_21_at_ionization);
@@ -545,7 +796,6 @@ void free_reionization_grids()
     fftwf_free(grids->sfr_filtered);
     fftwf_free(grids->deltax_filtered);
     fftwf_free(grids->deltax);
-    fftwf_free(grids->deltax_temp);
     fftwf_free(grids->stars_filtered);
     fftwf_free(grids->xH);
 
@@ -555,15 +805,16 @@ void free_reionization_grids()
         fftwf_free(grids->Tk_box);
         fftwf_free(grids->TS_box);
 
-        free(grids->SMOOTHED_SFR_GAL);
-        free(grids->SMOOTHED_SFR_QSO);
+        if (!run_globals.params.ReionLeanMemory)
+            free_smoothed_sfr_grids();
 
+        free_heat_tables();
     }
 
     if(run_globals.params.Flag_IncludeRecombinations) {
-        fftwf_free(grids->N_rec_filtered);
+        free_MHR();
+
         fftwf_free(grids->N_rec);
-        fftwf_free(grids->N_rec_prev);
 
         fftwf_free(grids->z_re);
         fftwf_free(grids->Gamma12);
@@ -600,10 +851,11 @@ void free_reionization_grids()
 
     fftwf_free(grids->stars);
     fftwf_free(grids->sfr);
-    fftwf_free(grids->stars_temp);
     fftwf_free(grids->sfr_temp);
     fftwf_free(grids->buffer);
 
+    free_filter_kernel();
+
     mlog(" ...done", MLOG_CLOSE);
 }
 
@@ -625,6 +877,7 @@ int map_galaxies_to_slabs(int ngals)
 
     galaxy_t* gal = run_globals.FirstGal;
     int gal_counter = 0;
+    run_globals.NGalaxyListPasses++;
     while (gal != NULL) {
         // TODO: Note that I am including ghosts here.  We will need to check the
         // validity of this.  By definition, if they are ghosts then their host
@@ -808,6 +1061,10 @@ void construct_baryon_grids(int snapshot, int local_ngals)
         long N_BlackHoleMassLimitReion = 0;
 
         for (int i_r = 0; i_r < run_globals.mpi_size; i_r++) {
+            // ranks without a slab can't have any galaxies mapped to them, so there is nothing to reduce
+            if (slab_nix[i_r] == 0)
+                continue;
+
             // init the buffer
             for (int ii = 0; ii < buffer_size; ii++)
                 buffer[ii] = (float)0.;
@@ -1273,63 +1530,141 @@ bool check_if_reionization_ongoing(int snapshot)
 
 void filter(fftwf_complex* box, int local_ix_start, int slab_nx, int grid_dim, float R, int filter_type)
 {
+    filter_many(box, 1, local_ix_start, slab_nx, grid_dim, R, filter_type);
+}
+
+static float filter_kernel(float kR, int filter_type)
+{
+    // The radial filter W(kR)
+    switch (filter_type) {
+        case 0: // Real space top-hat
+            if (kR > 1e-4)
+                return (float)(3.0 * (sinf(kR) / powf(kR, 3) - cosf(kR) / powf(kR, 2)));
+            return 1.0f;
+
+        case 1: // k-space top hat
+            kR *= 0.413566994; // Equates integrated volume to the real space top-hat (9pi/2)^(-1/3)
+            return (kR > 1) ? 0.0f : 1.0f;
+
+        case 2: // Gaussian
+            kR *= 0.643; // Equates integrated volume to the real space top-hat
+            return powf((float)M_E, (float)(-kR * kR / 2.0));
+
+        default:
+            mlog_error("ReionFilterType.c: Warning, ReionFilterType type %d is undefined!", filter_type);
+            ABORT(EXIT_FAILURE);
+    }
+
+    return 1.0f;
+}
+
+static void* grow_filter_scratch(void* ptr, int* size, int n, size_t elem_size)
+{
+    if (n <= *size)
+        return ptr;
+
+    ptr = realloc(ptr, elem_size * (size_t)n);
+    if (ptr == NULL) {
+        mlog_error("Failed to allocate the filter kernel scratch!");
+        ABORT(EXIT_FAILURE);
+    }
+    *size = n;
+
+    return ptr;
+}
+
+static const filter_kernel_t* tabulate_filter_kernel(int local_ix_start, int slab_nx, int grid_dim, float R, int filter_type)
+{
+    // |k|^2 only takes the values delta_k^2 * (n_x^2 + n_y^2 + n_z^2) with
+    // |n_y|, n_z <= middle, so we can tabulate W(kR) exactly on the integer |n|^2
+    // for this R and reduce the loop over the k-box to a lookup and multiply.
+    // Only the values of n_x^2 in the local slab are needed, which bounds the
+    // table (and the number of kernel evaluations) by the slab rather than the box.
+    filter_kernel_t* fk = &(run_globals.reion_grids.filter_kernel);
     int middle = grid_dim / 2;
     float box_size = (float)run_globals.params.BoxSize;
-    float delta_k = (float)(2.0 * M_PI / box_size);
-
-    // Loop through k-box
-    for (int n_x = 0; n_x < slab_nx; n_x++) {
-        float k_x;
-        int n_x_global = n_x + local_ix_start;
 
-        if (n_x_global > middle)
-            k_x = (n_x_global - grid_dim) * delta_k;
-        else
-            k_x = n_x_global * delta_k;
+    bool same_slab = (fk->n_x2 != NULL) && (fk->grid_dim == grid_dim) && (fk->local_ix_start == local_ix_start)
+        && (fk->slab_nx == slab_nx) && (fk->box_size == box_size);
+
+    if (!same_slab) {
+        fk->n_x2 = grow_filter_scratch(fk->n_x2, &(fk->n_x2_size), slab_nx > 0 ? slab_nx : 1, sizeof(int));
+        fk->n_y2 = grow_filter_scratch(fk->n_y2, &(fk->n_y2_size), grid_dim, sizeof(int));
+
+        int max_n_x2 = 0;
+        for (int n_x = 0; n_x < slab_nx; n_x++) {
+            int n_x_global = n_x + local_ix_start;
+            if (n_x_global > middle)
+                n_x_global -= grid_dim;
+            fk->n_x2[n_x] = n_x_global * n_x_global;
+            if (fk->n_x2[n_x] > max_n_x2)
+                max_n_x2 = fk->n_x2[n_x];
+        }
 
         for (int n_y = 0; n_y < grid_dim; n_y++) {
-            float k_y;
+            int n_y_signed = (n_y > middle) ? n_y - grid_dim : n_y;
+            fk->n_y2[n_y] = n_y_signed * n_y_signed;
+        }
 
-            if (n_y > middle)
-                k_y = (n_y - grid_dim) * delta_k;
-            else
-                k_y = n_y * delta_k;
+        fk->grid_dim = grid_dim;
+        fk->local_ix_start = local_ix_start;
+        fk->slab_nx = slab_nx;
+        fk->box_size = box_size;
+        fk->n_kernel = (slab_nx > 0) ? max_n_x2 + 2 * middle * middle + 1 : 0;
+        fk->kernel = grow_filter_scratch(fk->kernel, &(fk->kernel_size), fk->n_kernel > 0 ? fk->n_kernel : 1, sizeof(float));
+    }
 
-            for (int n_z = 0; n_z <= middle; n_z++) {
-                float k_z = n_z * delta_k;
+    if (!same_slab || (fk->R != R) || (fk->filter_type != filter_type)) {
+        float delta_k = (float)(2.0 * M_PI / box_size);
+        for (int ii = 0; ii < fk->n_kernel; ii++)
+            fk->kernel[ii] = filter_kernel(delta_k * sqrtf((float)ii) * R, filter_type);
+
+        fk->R = R;
+        fk->filter_type = filter_type;
+    }
 
-                float k_mag = sqrtf(k_x * k_x + k_y * k_y + k_z * k_z);
+    return fk;
+}
 
-                float kR = k_mag * R; // Real space top-hat
+void free_filter_kernel()
+{
+    filter_kernel_t* fk = &(run_globals.reion_grids.filter_kernel);
 
-                switch (filter_type) {
-                    case 0: // Real space top-hat
-                        if (kR > 1e-4)
-                            box[grid_index(n_x, n_y, n_z, grid_dim, INDEX_COMPLEX_HERM)] *= (fftwf_complex)(3.0 * (sinf(kR) / powf(kR, 3) - cosf(kR) / powf(kR, 2)));
-                        break;
+    free(fk->kernel);
+    free(fk->n_y2);
+    free(fk->n_x2);
 
-                    case 1: // k-space top hat
-                        kR *= 0.413566994; // Equates integrated volume to the real space top-hat (9pi/2)^(-1/3)
-                        if (kR > 1)
-                            box[grid_index(n_x, n_y, n_z, grid_dim, INDEX_COMPLEX_HERM)] = (fftwf_complex)0.0;
-                        break;
+    *fk = (filter_kernel_t){ 0 };
+}
 
-                    case 2: // Gaussian
-                        kR *= 0.643; // Equates integrated volume to the real space top-hat
-                        box[grid_index(n_x, n_y, n_z, grid_dim, INDEX_COMPLEX_HERM)] *= (fftwf_complex)(powf((float)M_E,
-                                    (float)(-kR * kR / 2.0)));
-                        break;
+size_t filter_kernel_bytes()
+{
+    filter_kernel_t* fk = &(run_globals.reion_grids.filter_kernel);
 
-                    default:
-                        if ((n_x == 0) && (n_y == 0) && (n_z == 0)) {
-                            mlog_error("ReionFilterType.c: Warning, ReionFilterType type %d is undefined!", filter_type);
-                            ABORT(EXIT_FAILURE);
-                        }
-                        break;
-                }
+    return sizeof(int) * (size_t)(fk->n_x2_size + fk->n_y2_size) + sizeof(float) * (size_t)fk->kernel_size;
+}
+
+void filter_many(fftwf_complex* box, int n_fields, int local_ix_start, int slab_nx, int grid_dim, float R, int filter_type)
+{
+    // Apply the same filter to `n_fields` interleaved k-space fields (i.e. box[i_cell * n_fields + i_field])
+    int n_z_complex = grid_dim / 2 + 1;
+
+    const filter_kernel_t* fk = tabulate_filter_kernel(local_ix_start, slab_nx, grid_dim, R, filter_type);
+    const int* n_x2 = fk->n_x2;
+    const int* n_y2 = fk->n_y2;
+
+    // Loop through k-box
+    for (int n_x = 0; n_x < slab_nx; n_x++)
+        for (int n_y = 0; n_y < grid_dim; n_y++) {
+            const float* kernel_row = fk->kernel + n_x2[n_x] + n_y2[n_y];
+            fftwf_complex* row = box + (ptrdiff_t)grid_index(n_x, n_y, 0, grid_dim, INDEX_COMPLEX_HERM) * n_fields;
+
+            for (int n_z = 0; n_z < n_z_complex; n_z++) {
+                float w = kernel_row[n_z * n_z];
+                for (int i_field = 0; i_field < n_fields; i_field++)
+                    row[n_z * n_fields + i_field] *= w;
             }
-        }
-    } // End looping through k box
+        } // End looping through k box
 }
 
 void velocity_gradient(fftwf_complex* box, int local_ix_start, int slab_nx, int grid_dim)
@@ -7,13 +7,13 @@
 float current_mwmsa(galaxy_t* gal, int i_snap)
 {
     double* LTTime = run_globals.LTTime;
-    double mwmsa_num = gal->mwmsa_num;
-    double mwmsa_denom = gal->mwmsa_denom;
+    double mwmsa_num = gal->Aux->mwmsa_num;
+    double mwmsa_denom = gal->Aux->mwmsa_denom;
     int snapshot = run_globals.ListOutputSnaps[i_snap];
 
     for (int ii = 0, jj = snapshot; (ii < N_HISTORY_SNAPS) && (jj >= 0); ii++, jj--) {
-        mwmsa_num += gal->NewStars[ii] * LTTime[jj];
-        mwmsa_denom += gal->NewStars[ii];
+        mwmsa_num += gal->Aux->NewStars[ii] * LTTime[jj];
+        mwmsa_denom += gal->Aux->NewStars[ii];
     }
 
     return (float)((mwmsa_num / mwmsa_denom) - LTTime[snapshot]);
@@ -30,8 +30,8 @@ void prepare_galaxy_for_output(
     galout->Type = gal.Type;
     if (!gal.ghost_flag) {
         galout->HaloID = (long long)gal.Halo->ID;
-        galout->CentralGal = gal.Halo->FOFGroup->FirstOccupiedHalo->Galaxy->output_index;
-        galout->FOFMvir = (float)(gal.Halo->FOFGroup->Mvir);
+        galout->CentralGal = fof_first_occupied_halo(halo_fof_group(gal.Halo))->Galaxy->output_index;
+        galout->FOFMvir = (float)(halo_fof_group(gal.Halo)->Mvir);
     } else {
         galout->HaloID = -1;
         galout->CentralGal = -1;
@@ -75,18 +75,18 @@ void prepare_galaxy_for_output(
     galout->EjectedGas = (float)(gal.EjectedGas);
     galout->MetalsEjectedGas = (float)(gal.MetalsEjectedGas);
     galout->Rcool = (float)(gal.Rcool);
-    galout->Cos_Inc = (float)(gal.Cos_Inc);
+    galout->Cos_Inc = (float)(gal.Aux->Cos_Inc);
     galout->BaryonFracModifier = (float)(gal.BaryonFracModifier);
     galout->FOFMvirModifier = (float)(gal.FOFMvirModifier);
     galout->MvirCrit = (float)(gal.MvirCrit);
     galout->dt = (float)(gal.dt * units->UnitTime_in_Megayears);
     galout->MergerBurstMass = (float)(gal.MergerBurstMass);
     galout->MergTime = (float)(gal.MergTime * units->UnitTime_in_Megayears);
-    galout->MergerStartRadius = (float)(gal.MergerStartRadius);
+    galout->MergerStartRadius = (float)(gal.Aux->MergerStartRadius);
     galout->MWMSA = current_mwmsa(&gal, i_snap);
 
     for (int ii = 0; ii < N_HISTORY_SNAPS; ii++)
-        galout->NewStars[ii] = (float)(gal.NewStars[ii]);
+        galout->NewStars[ii] = (float)(gal.Aux->NewStars[ii]);
 
 #ifdef CALC_MAGS
     get_output_magnitudes(galout->Mags, &gal, run_globals.ListOutputSnaps[i_snap]);
@@ -874,44 +874,13 @@ void write_snapshot(
     int old_count = 0;
     int* first_progenitor_index = NULL;
     int* next_progenitor_index = NULL;
+    int* descendant_index = NULL;
     int calc_descendants_i_out = -1;
     int prev_snapshot = -1;
     int write_count = 0;
 
     mlog("Writing output file (n_write = %d)...", MLOG_OPEN | MLOG_TIMERSTART, n_write);
 
-    // We aren't going to write any galaxies that have zero stellar mass, so
-    // modify n_write appropriately...
-    gal = run_globals.FirstGal;
-    while (gal != NULL) {
-        if (pass_write_check(gal, false))
-            write_count++;
-        gal = gal->Next;
-    }
-
-    if (n_write != write_count) {
-        mlog("Excluding %d ~zero mass galaxies...", MLOG_MESG, n_write - write_count);
-        mlog("New write count = %d", MLOG_MESG, write_count);
-        n_write = write_count;
-    }
-
-    // Create the file.
-    file_id = H5Fopen(run_globals.FNameOut, H5F_ACC_RDWR, H5P_DEFAULT);
-
-    // Create the relevant group.
-    sprintf(target_group, "Snap%03d", (run_globals.ListOutputSnaps)[i_out]);
-    group_id = H5Gcreate(file_id, target_group, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-
-    // reset the chunk size if required
-    if ((int)chunk_size < n_write)
-        chunk_size = (hsize_t)n_write;
-
-    // Make the table
-    H5TBmake_table("Galaxies", group_id, "Galaxies",
-        (hsize_t)h5props.n_props, (hsize_t)n_write, h5props.dst_size, h5props.field_names,
-        h5props.dst_offsets, h5props.field_types, chunk_size, fill_data, 1,
-        NULL);
-
     // If the immediately preceding snapshot was also written, then save the
     // descendent indices
     prev_snapshot = run_globals.ListOutputSnaps[i_out] - 1;
@@ -923,12 +892,12 @@ void write_snapshot(
             }
     }
 
-    // Assign the write order indices to each galaxy and store the old indices if required
-    gal_count = 0;
-    old_count = 0;
+    // Assign the write order indices to each galaxy, storing the old indices
+    // if required, and count the galaxies we will actually write.  The input
+    // n_write is an upper limit on this count.
     if (calc_descendants_i_out > -1) {
         // malloc the arrays
-        int* descendant_index = malloc(sizeof(int) * (*last_n_write));
+        descendant_index = malloc(sizeof(int) * (*last_n_write));
         next_progenitor_index = malloc(sizeof(int) * (*last_n_write));
         first_progenitor_index = malloc(sizeof(int) * n_write);
 
@@ -939,30 +908,60 @@ void write_snapshot(
         }
         for (int ii = 0; ii < n_write; ii++)
             first_progenitor_index[ii] = -1;
+    }
 
-        // loop through the current galaxies and save their first progenitor
-        // indices as their previous output_index, and the descendent indices of
-        // the last snapshot to what will be the output index when the current
-        // galaxy is written.
-        gal = run_globals.FirstGal;
-        while (gal != NULL) {
-            if (pass_write_check(gal, false)) {
-                if (gal->output_index > -1) {
-                    first_progenitor_index[gal_count] = gal->output_index;
+    // loop through the current galaxies and save their first progenitor
+    // indices as their previous output_index, and the descendent indices of
+    // the last snapshot to what will be the output index when the current
+    // galaxy is written.
+    gal = run_globals.FirstGal;
+    run_globals.NGalaxyListPasses++;
+    while (gal != NULL) {
+        if (pass_write_check(gal, false)) {
+            if ((calc_descendants_i_out > -1) && (gal->output_index > -1)) {
+                assert(write_count < n_write);
+                first_progenitor_index[write_count] = gal->output_index;
 
-                    assert(gal->output_index < *last_n_write);
+                assert(gal->output_index < *last_n_write);
 
-                    descendant_index[gal->output_index] = gal_count;
-                    old_count++;
-                }
-                gal->output_index = gal_count++;
+                descendant_index[gal->output_index] = write_count;
+                old_count++;
             }
-            gal = gal->Next;
+            gal->output_index = write_count++;
         }
+        gal = gal->Next;
+    }
+
+    // We aren't going to write any galaxies that have zero stellar mass, so
+    // modify n_write appropriately...
+    if (n_write != write_count) {
+        mlog("Excluding %d ~zero mass galaxies...", MLOG_MESG, n_write - write_count);
+        mlog("New write count = %d", MLOG_MESG, write_count);
+        n_write = write_count;
+    }
 
+    // Create the file.
+    file_id = H5Fopen(run_globals.FNameOut, H5F_ACC_RDWR, H5P_DEFAULT);
+
+    // Create the relevant group.
+    sprintf(target_group, "Snap%03d", (run_globals.ListOutputSnaps)[i_out]);
+    group_id = H5Gcreate(file_id, target_group, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    // reset the chunk size if required
+    if ((int)chunk_size < n_write)
+        chunk_size = (hsize_t)n_write;
+
+    // Make the table
+    H5TBmake_table("Galaxies", group_id, "Galaxies",
+        (hsize_t)h5props.n_props, (hsize_t)n_write, h5props.dst_size, h5props.field_names,
+        h5props.dst_offsets, h5props.field_types, chunk_size, fill_data, 1,
+        NULL);
+
+    if (calc_descendants_i_out > -1) {
         // Here we want to walk the progenitor indices to tag on galaxies which
         // have merged in this timestep and also set their descendant_index.
         gal = run_globals.FirstGal;
+        run_globals.NGalaxyListPasses++;
         while (gal != NULL) {
             if (pass_write_check(gal, true)) {
                 assert((gal->output_index < *last_n_write) && (gal->output_index >= 0));
@@ -990,21 +989,6 @@ void write_snapshot(
         free(first_progenitor_index);
         free(next_progenitor_index);
         free(descendant_index);
-
-    } else {
-
-        gal = run_globals.FirstGal;
-        while (gal != NULL) {
-            if (pass_write_check(gal, false))
-                gal->output_index = gal_count++;
-            gal = gal->Next;
-        }
-    }
-
-    if (n_write != gal_count) {
-        fprintf(stderr, "We don't have the expected number of galaxies in save...");
-        fprintf(stderr, "gal_count=%d, n_write=%d", gal_count, n_write);
-        ABORT(EXIT_FAILURE);
     }
 
     // Write the galaxies.
@@ -1012,6 +996,7 @@ void write_snapshot(
     // This can cause significant memory overhead if `chunk_size` is large.
     gal_count = 0;
     gal = run_globals.FirstGal;
+    run_globals.NGalaxyListPasses++;
     output_buffer = calloc((int)chunk_size, sizeof(galaxy_output_t));
     int buffer_count = 0;
     while (gal != NULL) {
@@ -0,0 +1,40 @@
+#include "meraxes.h"
+#include <math.h>
+
+static void fill_snapshot_consts(snapshot_consts_t* consts, int snapshot)
+{
+    physics_params_t* params = &(run_globals.params.physics);
+    double redshift = run_globals.ZZ[snapshot];
+    double zplus1 = 1.0 + redshift;
+
+    consts->redshift = redshift;
+    consts->RvirFactor = calculate_Rvir_factor(snapshot);
+
+    consts->SfEfficiencyZScaling = pow(zplus1, params->SfEfficiencyScaling);
+    consts->SnReheatZScaling = pow(zplus1 / 4., params->SnReheatRedshiftDep);
+    consts->SnEjectionZScaling = pow(zplus1 / 4., params->SnEjectionRedshiftDep);
+    consts->QuasarModeZScaling = pow(zplus1, params->quasar_mode_scaling);
+    consts->EscapeFracZScaling = pow(zplus1 / 6.0, params->EscapeFracRedshiftScaling);
+    consts->EscapeFracBH = (float)(params->EscapeFracBHNorm * (powf((float)(zplus1 / 6.0), (float)params->EscapeFracBHScaling)));
+
+    consts->ReionMassScale = reionization_mass_scale(redshift);
+}
+
+//! Calculate the snapshot constants for every snapshot.  This needs to be
+//! redone whenever the parameters change (i.e. at the start of each run).
+void set_snapshot_consts()
+{
+    int n_snaps = run_globals.params.SnaplistLength;
+
+    if (run_globals.SnapshotConsts == NULL)
+        run_globals.SnapshotConsts = malloc(sizeof(snapshot_consts_t) * n_snaps);
+
+    for (int snapshot = 0; snapshot < n_snaps; snapshot++)
+        fill_snapshot_consts(&(run_globals.SnapshotConsts[snapshot]), snapshot);
+}
+
+//! Return the snapshot constants for `snapshot`
+const snapshot_consts_t* get_snapshot_consts(int snapshot)
+{
+    return &(run_globals.SnapshotConsts[snapshot]);
+}
@@ -15,9 +15,11 @@
 
 static double age[NAGE];
 static double yield_tables[NELEMENT][NMETAL*NAGE];
-static double yield_tables_working[N_HISTORY_SNAPS][NMETAL][NELEMENT];
 static double energy_tables[NMETAL*NAGE];
-static double energy_tables_working[N_HISTORY_SNAPS][NMETAL];
+// The working tables for the current snapshot are stored so that the history
+// of each integer metallicity is contiguous.
+static double yield_tables_working[NELEMENT][NMETAL][N_HISTORY_SNAPS];
+static double energy_tables_working[NMETAL][N_HISTORY_SNAPS];
 
 
 void check_n_history_snaps(void) {
@@ -129,14 +131,14 @@ void compute_stellar_feedback_tables(int snapshot) {
             for(int i_element = 0; i_element < NELEMENT; ++i_element) {
                 pData = yield_tables[i_element];
                 for(int i_metal = 0; i_metal < NMETAL; ++i_metal) {
-                    yield_tables_working[i_burst][i_metal][i_element] = \
+                    yield_tables_working[i_element][i_metal][i_burst] = \
                     trapz_table(pData, age, NAGE, t_begin, t_end);
                     pData += NAGE;
                 }
             }
             pData = energy_tables;
             for(int i_metal = 0; i_metal < NMETAL; ++i_metal) {
-                energy_tables_working[i_burst][i_metal] = \
+                energy_tables_working[i_metal][i_burst] = \
                 interp(t_end, age, pData, NAGE) - interp(t_begin, age, pData, NAGE);
                 pData += NAGE;
             }
@@ -146,9 +148,9 @@ void compute_stellar_feedback_tables(int snapshot) {
             // yields and energy injection are negligible.
             for(int i_element = 0; i_element < NELEMENT; ++i_element)
                 for(int i_metal = 0; i_metal < NMETAL; ++i_metal)
-                    yield_tables_working[i_burst][i_metal][i_element] = 0.;
+                    yield_tables_working[i_element][i_metal][i_burst] = 0.;
             for(int i_metal = 0; i_metal < NMETAL; ++i_metal)
-                energy_tables_working[i_burst][i_metal] = 0.;
+                energy_tables_working[i_metal][i_burst] = 0.;
         }
     }
 }
@@ -166,19 +168,52 @@ static inline int get_integer_metallicity(double metals) {
 
 double get_recycling_fraction(int i_burst, double metals) {
     // The recycling fraction equals to the yield of all elements including H & He
-    return yield_tables_working[i_burst][get_integer_metallicity(metals)][RECYCLING_FRACTION];
+    return yield_tables_working[RECYCLING_FRACTION][get_integer_metallicity(metals)][i_burst];
 }
 
 
 double get_metal_yield(int i_burst, double metals) {
     // The metal yield includes all elements execpt H & He
-    return yield_tables_working[i_burst][get_integer_metallicity(metals)][TOTAL_METAL];
+    return yield_tables_working[TOTAL_METAL][get_integer_metallicity(metals)][i_burst];
 }
 
 
 double get_SN_energy(int i_burst, double metals) {
     // Convert the metallicity to an integer
-    return energy_tables_working[i_burst][get_integer_metallicity(metals)];
+    return energy_tables_working[get_integer_metallicity(metals)][i_burst];
+}
+
+
+void get_SN_history_feedback(const double* new_stars, const double* new_metals, int n_bursts,
+    double* m_recycled, double* metal_yield, double* sn_energy)
+{
+    // Accumulate the recycled mass, metals and SNII energy released in the
+    // current time step by bursts 1 to `n_bursts - 1` of the star formation
+    // history.  Bursts which formed no stars are masked out rather than
+    // skipped, so that there is no data dependent control flow and the
+    // compiler is free to vectorise this loop (using gathers for the tables).
+    const double* recycling_fraction = &(yield_tables_working[RECYCLING_FRACTION][0][0]);
+    const double* total_metal = &(yield_tables_working[TOTAL_METAL][0][0]);
+    const double* energy = &(energy_tables_working[0][0]);
+    double recycled_sum = 0.0;
+    double metals_sum = 0.0;
+    double energy_sum = 0.0;
+
+    for (int i_burst = 1; i_burst < n_bursts; i_burst++) {
+        double m_stars = (new_stars[i_burst] > 1e-10) ? new_stars[i_burst] : 0.0;
+        double metallicity = ((m_stars > 0.0) && (new_metals[i_burst] > 0.0)) ? new_metals[i_burst] / m_stars : 0.0;
+        if (metallicity > 1.0)
+            metallicity = 1.0;
+        int ind = get_integer_metallicity(metallicity) * N_HISTORY_SNAPS + i_burst;
+
+        recycled_sum += m_stars * recycling_fraction[ind];
+        metals_sum += m_stars * total_metal[ind];
+        energy_sum += m_stars * energy[ind];
+    }
+
+    *m_recycled = recycled_sum;
+    *metal_yield = metals_sum;
+    *sn_energy = energy_sum;
 }
 
 
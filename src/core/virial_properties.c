@@ -90,11 +90,10 @@ double hubble_time(int snapshot)
     return 1.0 / hubble_at_snapshot(snapshot);
 }
 
-double calculate_Rvir(double Mvir, int snapshot)
+double calculate_Rvir_factor(int snapshot)
 {
     double hubble_of_z_sq;
     double rhocrit;
-    double fac;
     double Delta;
 
     hubble_of_z_sq = pow(hubble_at_snapshot(snapshot), 2);
@@ -103,9 +102,14 @@ double calculate_Rvir(double Mvir, int snapshot)
 
     Delta = Delta_vir(run_globals.ZZ[snapshot]);
 
-    fac = 1 / (Delta * 4 * M_PI / 3.0 * rhocrit);
+    return 1 / (Delta * 4 * M_PI / 3.0 * rhocrit);
+}
+
+double calculate_Rvir(double Mvir, int snapshot)
+{
+    const snapshot_consts_t* consts = get_snapshot_consts(snapshot);
 
-    return cbrt(Mvir * fac);
+    return cbrt(Mvir * consts->RvirFactor);
 }
 
 double calculate_Vvir(double Mvir, double Rvir)
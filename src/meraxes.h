@@ -1,3 +1,4 @@
+#include <assert.h>
 #include <complex.h>
 #include <fftw3.h>
 #include <gsl/gsl_rng.h>
@@ -32,6 +33,7 @@
 // ======================================================
 // Don't change these unless you know what you are doing!
 #define STRLEN 256 //!< Default string length
+#define GALAXY_POOL_BLOCK_SIZE 16384 //!< Number of galaxies per pool allocation
 // ======================================================
 
 // Define things used for aborting exceptions
@@ -39,14 +41,33 @@
 extern "C" {
 #endif
     void myexit(int signum);
+    void flag_thread_abort(int signum);
+    bool thread_abort_flagged(void);
+    void check_thread_abort(void);
 #ifdef __cplusplus
 }
 #endif
+#ifdef USE_OPENMP
+#include <omp.h>
+// MPI is only initialised with MPI_THREAD_FUNNELED, so an ABORT reached from
+// within an OpenMP parallel region can't shut down MPI itself.  Instead it
+// flags the failure and the master thread aborts the run by calling
+// check_thread_abort() once the parallel region has ended.
+#define ABORT(sigterm)                                                                 \
+    do {                                                                                   \
+        fprintf(stderr, "\nIn file: %s\tfunc: %s\tline: %i\n", __FILE__, __FUNCTION__, __LINE__);  \
+        if (omp_in_parallel())                                                               \
+            flag_thread_abort(sigterm);                                                      \
+        else                                                                                 \
+            myexit(sigterm);                                                                 \
+    } while (0)
+#else
 #define ABORT(sigterm)                                                                 \
     do {                                                                                   \
         fprintf(stderr, "\nIn file: %s\tfunc: %s\tline: %i\n", __FILE__, __FUNCTION__, __LINE__);  \
         myexit(sigterm);                                                                     \
     } while (0)
+#endif
 
 // Units (cgs):
 #define GRAVITY 6.672e-8
@@ -293,6 +314,10 @@ typedef struct run_params_t {
     double ReionPowerSpecDeltaK;
     int ReionGridDim;
     int ReionFilterType;
+    int ReionFFTWPlannerRigor;
+    int ReionFFTWNThreads;
+    int ReionLeanMemory;
+    int ReionNGridRanks;
     int TsHeatingFilterType;
     int ReionRtoMFilterType;
     int ReionUVBFlag;
@@ -308,6 +333,7 @@ typedef struct run_params_t {
     int FlagMCMC;
     int Flag_PatchyReion;
     int Flag_IncludeSpinTemp;
+    int Flag_CacheXHeatingTables;
     int Flag_IncludeRecombinations;
     int Flag_Compute21cmBrightTemp;
     int Flag_ComputePS;
@@ -316,6 +342,8 @@ typedef struct run_params_t {
 
     int TsVelocityComponent;
     int TsNumFilterSteps;
+    int TsFloatSmoothedSFR;
+    int TsTauXTableNNu;
 
     double ReionSfrTimescale;
 
@@ -369,6 +397,25 @@ typedef struct gal_to_slab_t {
     int slab_ind;
 } gal_to_slab_t;
 
+// Scratch for `filter_many`.  The |n|^2 tables depend only on the slab and the kernel table on (R, filter_type), so
+// each is only rebuilt when these change and the arrays are only reallocated when they need to grow.
+typedef struct filter_kernel_t {
+    int* n_x2;
+    int* n_y2;
+    float* kernel;
+    int n_x2_size;
+    int n_y2_size;
+    int kernel_size;
+
+    int grid_dim;
+    int local_ix_start;
+    int slab_nx;
+    int n_kernel;
+    float box_size;
+    float R;
+    int filter_type;
+} filter_kernel_t;
+
 typedef struct reion_grids_t {
     ptrdiff_t* slab_nix;
     ptrdiff_t* slab_ix_start;
@@ -396,19 +443,17 @@ typedef struct reion_grids_t {
 
     // Grids necessary for the IGM spin temperature
     fftwf_complex* x_e_unfiltered;
-    fftwf_complex* x_e_filtered;
     float* x_e_box;
     float* x_e_box_prev;
     float* Tk_box;
     float* Tk_box_prev;
     float* TS_box;
 
-    double* SMOOTHED_SFR_GAL;
-    double* SMOOTHED_SFR_QSO;
+    void* SMOOTHED_SFR_GAL; //!< double, or float if TsFloatSmoothedSFR is set
+    void* SMOOTHED_SFR_QSO; //!< double, or float if TsFloatSmoothedSFR is set
 
     // Grids necessary for inhomogeneous recombinations
     fftwf_complex* N_rec_unfiltered;
-    fftwf_complex* N_rec_filtered;
     float* z_re;
     float* N_rec;
     float* N_rec_prev;
@@ -430,8 +475,22 @@ typedef struct reion_grids_t {
     float *PS_data;
     float *PS_error;
 
+    // The fields filtered at each radius in find_HII_bubbles, interleaved so
+    // they can be filtered and inverse transformed together (deltax, stars,
+    // sfr, then N_rec and x_e if enabled)
+    fftwf_complex* filtered_fields;
+    int n_filtered_fields;
+    size_t find_HII_bubbles_buffer_bytes; //!< set by `malloc_find_HII_bubbles_buffers`
+
+    filter_kernel_t filter_kernel;
+
     gal_to_slab_t* galaxy_to_slab_map;
 
+    // Persistent in-place plans for the ReionGridDim^3 slabs (see `create_reion_fftw_plans`)
+    fftwf_plan r2c_plan;
+    fftwf_plan c2r_plan;
+    fftwf_plan c2r_many_plan;
+
     double volume_weighted_global_xH;
     double mass_weighted_global_xH;
 
@@ -451,10 +510,14 @@ typedef struct reion_grids_t {
 } reion_grids_t;
 
 //! The meraxes halo structure
+//! N.B. Links between halos and FOF groups are stored as indices into the
+//! arrays of the snapshot the halo belongs to (-1 if unset), so that these
+//! arrays can be moved without invalidating them.
 typedef struct halo_t {
-    struct fof_group_t* FOFGroup;
-    struct halo_t* NextHaloInFOFGroup;
+    int FOFGroup; //!< Index of the parent FOF group
+    int NextHaloInFOFGroup; //!< Index of the next halo in the FOF group (or -1)
     struct galaxy_t* Galaxy;
+    struct galaxy_t* MergerMother; //!< Cached merger "mother" galaxy (NULL until needed)
 
     float Pos[3]; //!< Most bound particle position [Mpc/h]
     float Vel[3]; //!< Centre of mass velocity [Mpc/h]
@@ -475,8 +538,8 @@ typedef struct halo_t {
 } halo_t;
 
 typedef struct fof_group_t {
-    halo_t* FirstHalo;
-    halo_t* FirstOccupiedHalo;
+    int FirstHalo; //!< Index of the first halo in the group
+    int FirstOccupiedHalo; //!< Index of the first halo hosting a galaxy (or -1)
     double Mvir;
     double Rvir;
     double Vvir;
@@ -484,21 +547,43 @@ typedef struct fof_group_t {
     int TotalSubhaloLen;
 } fof_group_t;
 
-typedef struct galaxy_t {
+//! Bulky galaxy properties which are not needed by the per-substep physics.
+//! These live in a side allocation, pointed to by galaxy_t::Aux.
+typedef struct galaxy_aux_t {
+    // baryonic histories
     double NewStars[N_HISTORY_SNAPS];
     double NewMetals[N_HISTORY_SNAPS];
+    double mwmsa_num;
+    double mwmsa_denom;
 
-    #ifdef CALC_MAGS
+#ifdef CALC_MAGS
     double inBCFlux[MAGS_N];
     double outBCFlux[MAGS_N];
-    #endif
+#endif
 
-    // Unique ID for the galaxy
-    unsigned long ID;
+    // output only
+    double Cos_Inc;
+    double MergerStartRadius;
+} galaxy_aux_t;
+
+//! The meraxes galaxy structure.
+//! N.B. Fields are ordered roughly by how often the physics touches them.
+typedef struct galaxy_t {
+    // baryonic reservoirs
+    double HotGas;
+    double MetalsHotGas;
+    double ColdGas;
+    double MetalsColdGas;
+    double StellarMass;
+    double MetalsStellarMass;
+    double EjectedGas;
+    double MetalsEjectedGas;
+    double Sfr;
+    double DiskScaleLength;
+    double BlackHoleMass;
+    double BlackHoleAccretingColdMass;
 
     // properties of subhalo at the last time this galaxy was a central galaxy
-    float Pos[3];
-    float Vel[3];
     double Mvir;
     double Rvir;
     double Vvir;
@@ -506,53 +591,41 @@ typedef struct galaxy_t {
     double Spin;
 
     double dt; //!< Time between current snapshot and last identification
+    double MergTime;
 
     struct halo_t* Halo;
     struct galaxy_t* FirstGalInHalo;
     struct galaxy_t* NextGalInHalo;
     struct galaxy_t* Next;
     struct galaxy_t* MergerTarget;
+    struct galaxy_aux_t* Aux; //!< Owned by the galaxy pool; never reassigned
 
-    // baryonic reservoirs
-    double HotGas;
-    double MetalsHotGas;
-    double ColdGas;
-    double MetalsColdGas;
     double H2Frac;
     double H2Mass;
     double HIMass;
     double Mcool;
-    double StellarMass;
     double GrossStellarMass;
     double Fesc;
     double FescWeightedGSM;
-    double MetalsStellarMass;
-    double DiskScaleLength;
-    double Sfr;
-    double EjectedGas;
-    double MetalsEjectedGas;
-    double BlackHoleMass;
     double FescBH;
     double BHemissivity;
     double EffectiveBHM;
     double BlackHoleAccretedHotMass;
     double BlackHoleAccretedColdMass;
-    double BlackHoleAccretingColdMass;
-
-    // baryonic hostories
-    double mwmsa_num;
-    double mwmsa_denom;
 
     // misc
     double Rcool;
-    double Cos_Inc;
-    double MergTime;
-    double MergerStartRadius;
     double BaryonFracModifier;
     double FOFMvirModifier;
     double MvirCrit;
     double MergerBurstMass;
 
+    // Unique ID for the galaxy
+    unsigned long ID;
+
+    float Pos[3];
+    float Vel[3];
+
     int Type;
     int OldType;
     int Len;
@@ -564,9 +637,6 @@ typedef struct galaxy_t {
     int output_index; //!< write index
 
     bool ghost_flag;
-
-    // N.B. There will be padding present at the end of this struct, but amount
-    // is dependent on CALC_MAGS, MAX_PHOTO_NBANDS, NOUT and N_HISTORY_SNAPS.
 } galaxy_t;
 
 typedef struct galaxy_output_t {
@@ -635,6 +705,16 @@ typedef struct galaxy_output_t {
     float NewStars[N_HISTORY_SNAPS];
 } galaxy_output_t;
 
+//! Pooled storage for galaxy_t objects
+typedef struct galaxy_pool_t {
+    galaxy_t** blocks; //!< Contiguous blocks of GALAXY_POOL_BLOCK_SIZE galaxies
+    galaxy_aux_t** aux_blocks; //!< Matching blocks of auxiliary galaxy properties
+    galaxy_t* free_list; //!< Released galaxies, linked through their Next pointer
+    int n_blocks;
+    int n_blocks_max;
+    long long n_used;
+} galaxy_pool_t;
+
 //! Tree info struct
 typedef struct trees_info_t {
     int n_halos;
@@ -691,6 +771,19 @@ typedef struct mag_params_t {
 } mag_params_t;
 #endif
 
+//! Redshift dependent quantities which are constant across a snapshot
+typedef struct snapshot_consts_t {
+    double redshift;
+    double RvirFactor; //!< Rvir = cbrt(Mvir * RvirFactor)
+    double SfEfficiencyZScaling; //!< (1+z)^SfEfficiencyScaling
+    double SnReheatZScaling; //!< ((1+z)/4)^SnReheatRedshiftDep
+    double SnEjectionZScaling; //!< ((1+z)/4)^SnEjectionRedshiftDep
+    double QuasarModeZScaling; //!< (1+z)^quasar_mode_scaling
+    double EscapeFracZScaling; //!< ((1+z)/6)^EscapeFracRedshiftScaling
+    float EscapeFracBH; //!< Black hole escape fraction
+    double ReionMassScale; //!< Mass scale of the global reionization modifier
+} snapshot_consts_t;
+
 //! Global variables which will will be passed around
 typedef struct run_globals_t {
     struct run_params_t params;
@@ -700,6 +793,7 @@ typedef struct run_globals_t {
     hdf5_output_t hdf5props;
 
     MPI_Comm mpi_comm;
+    MPI_Comm reion_comm; //!< Sub-communicator of the ranks holding reionization grid slabs (MPI_COMM_NULL elsewhere)
     int mpi_rank;
     int mpi_size;
     gpu_info *gpu;
@@ -717,8 +811,12 @@ typedef struct run_globals_t {
     float** SnapshotDeltax;
     float** SnapshotVel;
     trees_info_t* SnapshotTreesInfo;
+    halo_t* CurrentHalo; //!< Halo array of the snapshot being processed
+    fof_group_t* CurrentFOFGroup; //!< FOF group array of the snapshot being processed
     struct galaxy_t* FirstGal;
     struct galaxy_t* LastGal;
+    galaxy_pool_t GalaxyPool;
+    snapshot_consts_t* SnapshotConsts; //!< Redshift dependent constants, indexed by snapshot
     gsl_rng* random_generator;
     void* mhysa_self;
     double Hubble;
@@ -733,6 +831,7 @@ typedef struct run_globals_t {
     int NOutputSnaps;
     int LastOutputSnap;
     int NGhosts;
+    int NGalaxyListPasses; //!< Full traversals of the galaxy list this snapshot
     int NHalosMax;
     int NFOFGroupsMax;
     int NRequestedForests;
@@ -748,6 +847,38 @@ run_globals_t run_globals;
 extern run_globals_t run_globals;
 #endif
 
+/*
+ * Halo and FOF group link accessors (for the snapshot being processed)
+ *
+ * N.B. These index into run_globals.CurrentHalo and run_globals.CurrentFOFGroup,
+ * which are only set while dracarys is processing a snapshot (and are NULL
+ * otherwise).
+ */
+
+static inline fof_group_t* halo_fof_group(const halo_t* halo)
+{
+    assert(run_globals.CurrentFOFGroup != NULL);
+    return &(run_globals.CurrentFOFGroup[halo->FOFGroup]);
+}
+
+static inline halo_t* next_halo_in_fof_group(const halo_t* halo)
+{
+    assert(run_globals.CurrentHalo != NULL);
+    return halo->NextHaloInFOFGroup < 0 ? NULL : &(run_globals.CurrentHalo[halo->NextHaloInFOFGroup]);
+}
+
+static inline halo_t* fof_first_halo(const fof_group_t* fof_group)
+{
+    assert(run_globals.CurrentHalo != NULL);
+    return &(run_globals.CurrentHalo[fof_group->FirstHalo]);
+}
+
+static inline halo_t* fof_first_occupied_halo(const fof_group_t* fof_group)
+{
+    assert(run_globals.CurrentHalo != NULL);
+    return fof_group->FirstOccupiedHalo < 0 ? NULL : &(run_globals.CurrentHalo[fof_group->FirstOccupiedHalo]);
+}
+
 /*
  * Functions
  */
@@ -774,8 +905,14 @@ void free_halo_storage(void);
 void initialize_halo_storage(void);
 
 void dracarys(void);
+void set_snapshot_consts(void);
+const snapshot_consts_t* get_snapshot_consts(int snapshot);
 int evolve_galaxies(fof_group_t* fof_group, int snapshot, int NGal, int NFof);
 void passively_evolve_ghost(galaxy_t* gal, int snapshot);
+void init_galaxy_pool(void);
+void free_galaxy_pool(void);
+galaxy_t* alloc_galaxy(void);
+void release_galaxy(galaxy_t* gal);
 galaxy_t* new_galaxy(int snapshot, unsigned long halo_ID);
 void create_new_galaxy(int snapshot, halo_t* halo, int* NGal, int* new_gal_counter, int* merger_counter);
 void kill_galaxy(galaxy_t* gal, galaxy_t* prev_gal, int* NGal, int* kill_counter);
@@ -787,6 +924,8 @@ void add_infall_to_hot(galaxy_t* central, double infall_mass);
 double calculate_merging_time(galaxy_t* gal, int snapshot);
 void merge_with_target(galaxy_t* gal, int* dead_gals, int snapshot);
 void insitu_star_formation(galaxy_t* gal, int snapshot);
+void init_pressure_dependent_star_formation(void);
+void free_pressure_dependent_star_formation(void);
 double pressure_dependent_star_formation(galaxy_t* gal, int snapshot);
 void update_reservoirs_from_sf(galaxy_t* gal, double new_stars, int snapshot, SFtype type);
 double sn_m_low(double log_dt);
@@ -831,6 +970,7 @@ double Tvir_to_Mvir(double T, double z);
 double hubble_at_snapshot(int snapshot);
 double hubble_time(int snapshot);
 double calculate_Mvir(double Mvir, int len);
+double calculate_Rvir_factor(int snapshot);
 double calculate_Rvir(double Mvir, int snapshot);
 double calculate_Vvir(double Mvir, double Rvir);
 double calculate_spin_param(halo_t* halo);
@@ -858,6 +998,7 @@ void compute_stellar_feedback_tables(int snapshot);
 double get_recycling_fraction(int i_burst, double metals);
 double get_metal_yield(int i_burst, double metals);
 double get_SN_energy(int i_burst, double metals);
+void get_SN_history_feedback(const double* new_stars, const double* new_metals, int n_bursts, double* m_recycled, double* metal_yield, double* sn_energy);
 double get_total_SN_energy(void);
 
 // Reionization related
@@ -865,10 +1006,14 @@ void read_Mcrit_table(void);
 double reionization_modifier(galaxy_t* gal, double Mvir, int snapshot);
 double sobacchi2013_modifier(double Mvir, double redshift);
 double gnedin2000_modifer(double Mvir, double redshift);
+double reionization_mass_scale(double redshift);
 void assign_slabs(void);
 void init_reion_grids(void);
 
 void filter(fftwf_complex* box, int local_ix_start, int slab_nx, int grid_dim, float R, int filter_type);
+void filter_many(fftwf_complex* box, int n_fields, int local_ix_start, int slab_nx, int grid_dim, float R, int filter_type);
+void free_filter_kernel(void);
+size_t filter_kernel_bytes(void);
 void set_fesc(int snapshot);
 void set_quasar_fobs(void);
 double RtoM(double R);
@@ -879,6 +1024,18 @@ void set_ReionEfficiency(void);
 int find_cell(float pos, double box_size);
 void malloc_reionization_grids(void);
 void free_reionization_grids(void);
+size_t malloc_find_HII_bubbles_buffers(void);
+void free_find_HII_bubbles_buffers(void);
+void malloc_smoothed_sfr_grids(void);
+void free_smoothed_sfr_grids(void);
+void create_reion_fftw_plans(void);
+void destroy_reion_fftw_plans(void);
+void reion_fftw_execute_r2c(fftwf_plan plan, float* in, fftwf_complex* out);
+void reion_fftw_execute_c2r(fftwf_plan plan, fftwf_complex* in, float* out);
+void init_MHR(void);
+void free_MHR(void);
+void init_heat_tables(void);
+void free_heat_tables(void);
 int map_galaxies_to_slabs(int ngals);
 void assign_Mvir_crit_to_galaxies(int ngals_in_slabs);
 void construct_baryon_grids(int snapshot, int ngals);
@@ -53,7 +53,7 @@ void update_reservoirs_from_quasar_mode_bh_feedback(galaxy_t* gal, double m_rehe
     if (gal->ghost_flag)
         central = gal;
     else
-        central = gal->Halo->FOFGroup->FirstOccupiedHalo->Galaxy;
+        central = fof_first_occupied_halo(halo_fof_group(gal->Halo))->Galaxy;
 
     if (m_reheat < gal->ColdGas) {
         metallicity = calc_metallicity(gal->ColdGas, gal->MetalsColdGas);
@@ -98,7 +98,7 @@ double radio_mode_BH_heating(galaxy_t* gal, double cooling_mass, double x)
         run_units_t* units = &(run_globals.units);
 
         if (gal->Type == 0)
-            Vvir = gal->Halo->FOFGroup->Vvir;
+            Vvir = halo_fof_group(gal->Halo)->Vvir;
         else
             Vvir = gal->Vvir;
 
@@ -154,12 +154,12 @@ void merger_driven_BH_growth(galaxy_t* gal, double merger_ratio, int snapshot)
         // If this galaxy is the central of it's FOF group then use the FOF Halo properties
         // TODO: This needs closer thought as to if this is the best thing to do...
         if (gal->Type == 0)
-            Vvir = gal->Halo->FOFGroup->Vvir;
+            Vvir = halo_fof_group(gal->Halo)->Vvir;
         else
             Vvir = gal->Vvir;
 
         // Suggested by Bonoli et al. 2009 and Wyithe et al. 2003
-        double z_scaling = pow((1 + run_globals.ZZ[snapshot]), run_globals.params.physics.quasar_mode_scaling);
+        double z_scaling = get_snapshot_consts(snapshot)->QuasarModeZScaling;
 
         double accreting_mass = run_globals.params.physics.BlackHoleGrowthRate * merger_ratio / (1.0 + (280.0 * 280.0 / Vvir / Vvir)) * gal->ColdGas * z_scaling;
 
@@ -191,7 +191,7 @@ void previous_merger_driven_BH_growth(galaxy_t* gal)
     // If this galaxy is the central of it's FOF group then use the FOF Halo properties
     // TODO: This needs closer thought as to if this is the best thing to do...
     if (gal->Type == 0)
-        Vvir = gal->Halo->FOFGroup->Vvir;
+        Vvir = halo_fof_group(gal->Halo)->Vvir;
     else
         Vvir = gal->Vvir;
 
@@ -8,7 +8,7 @@ double gas_cooling(galaxy_t* gal)
 
     // we only need to do cooling if there is anything to cool!
     if (gal->HotGas > 1e-10) {
-        fof_group_t* fof_group = gal->Halo->FOFGroup;
+        fof_group_t* fof_group = halo_fof_group(gal->Halo);
 
         // calculate the halo virial temperature
         // N.B. This assumes ionised gas with mu=0.59...
@@ -1,84 +1,104 @@
 #include "meraxes.h"
 
-//! Evolve existing galaxies forward in time
-int evolve_galaxies(fof_group_t* fof_group, int snapshot, int NGal, int NFof)
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+//! Evolve all of the galaxies in a single FOF group through every substep
+static void evolve_fof_group(fof_group_t* fof_group, int snapshot, int* gal_counter, int* dead_gals)
 {
     galaxy_t* gal = NULL;
     halo_t* halo = NULL;
-    int gal_counter = 0;
-    int dead_gals = 0;
     double infalling_gas = 0;
     double cooling_mass = 0;
     int NSteps = run_globals.params.NSteps;
     bool Flag_IRA = (bool)(run_globals.params.physics.Flag_IRA);
 
-    mlog("Doing physics...", MLOG_OPEN | MLOG_TIMERSTART);
-    // pre-calculate feedback tables for each lookback snapshot
-    compute_stellar_feedback_tables(snapshot);
-
-    for (int i_fof = 0; i_fof < NFof; i_fof++) {
-        // First check to see if this FOF group is empty.  If it is then skip it.
-        if (fof_group[i_fof].FirstOccupiedHalo == NULL)
-            continue;
-
-        infalling_gas = gas_infall(&(fof_group[i_fof]), snapshot);
-
-        for (int i_step = 0; i_step < NSteps; i_step++) {
-            halo = fof_group[i_fof].FirstHalo;
-            while (halo != NULL) {
-                gal = halo->Galaxy;
-
-                while (gal != NULL) {
-                    if (gal->Type == 0) {
-                        cooling_mass = gas_cooling(gal);
+    infalling_gas = gas_infall(fof_group, snapshot);
 
-                        add_infall_to_hot(gal, infalling_gas / ((double)NSteps));
+    for (int i_step = 0; i_step < NSteps; i_step++) {
+        halo = fof_first_halo(fof_group);
+        while (halo != NULL) {
+            gal = halo->Galaxy;
 
-                        reincorporate_ejected_gas(gal);
+            while (gal != NULL) {
+                if (gal->Type == 0) {
+                    cooling_mass = gas_cooling(gal);
 
-                        cool_gas_onto_galaxy(gal, cooling_mass);
-                    }
+                    add_infall_to_hot(gal, infalling_gas / ((double)NSteps));
 
-                    if (gal->Type < 3) {
-                        if (!Flag_IRA)
-                            delayed_supernova_feedback(gal, snapshot);
+                    reincorporate_ejected_gas(gal);
 
-                        if (gal->BlackHoleAccretingColdMass > 0)
-                            previous_merger_driven_BH_growth(gal);
+                    cool_gas_onto_galaxy(gal, cooling_mass);
+                }
 
-                        insitu_star_formation(gal, snapshot);
+                if (gal->Type < 3) {
+                    if (!Flag_IRA)
+                        delayed_supernova_feedback(gal, snapshot);
 
-                        // If this is a type 2 then decrement the merger clock
-                        if (gal->Type == 2)
-                            gal->MergTime -= gal->dt;
-                    }
+                    if (gal->BlackHoleAccretingColdMass > 0)
+                        previous_merger_driven_BH_growth(gal);
 
-                    if (i_step == NSteps - 1)
-                        gal_counter++;
+                    insitu_star_formation(gal, snapshot);
 
-                    gal = gal->NextGalInHalo;
+                    // If this is a type 2 then decrement the merger clock
+                    if (gal->Type == 2)
+                        gal->MergTime -= gal->dt;
                 }
 
-                halo = halo->NextHaloInFOFGroup;
+                if (i_step == NSteps - 1)
+                    (*gal_counter)++;
+
+                gal = gal->NextGalInHalo;
             }
 
-            // Check for mergers
-            halo = fof_group[i_fof].FirstHalo;
-            while (halo != NULL) {
-                gal = halo->Galaxy;
-                while (gal != NULL) {
-                    if (gal->Type == 2)
-                        // If the merger clock has run out or our target halo has already
-                        // merged then process a merger event.
-                        if ((gal->MergTime < 0) || (gal->MergerTarget->Type == 3))
-                            merge_with_target(gal, &dead_gals, snapshot);
+            halo = next_halo_in_fof_group(halo);
+        }
 
-                    gal = gal->NextGalInHalo;
-                }
-                halo = halo->NextHaloInFOFGroup;
+        // Check for mergers
+        halo = fof_first_halo(fof_group);
+        while (halo != NULL) {
+            gal = halo->Galaxy;
+            while (gal != NULL) {
+                if (gal->Type == 2)
+                    // If the merger clock has run out or our target halo has already
+                    // merged then process a merger event.
+                    if ((gal->MergTime < 0) || (gal->MergerTarget->Type == 3))
+                        merge_with_target(gal, dead_gals, snapshot);
+
+                gal = gal->NextGalInHalo;
             }
+            halo = next_halo_in_fof_group(halo);
         }
     }
+}
+
+//! Evolve existing galaxies forward in time
+int evolve_galaxies(fof_group_t* fof_group, int snapshot, int NGal, int NFof)
+{
+    int gal_counter = 0;
+    int dead_gals = 0;
+
+    mlog("Doing physics...", MLOG_OPEN | MLOG_TIMERSTART);
+    // pre-calculate feedback tables for each lookback snapshot
+    compute_stellar_feedback_tables(snapshot);
+
+    // N.B. Every galaxy (and merger target) touched while evolving a FOF group
+    // belongs to that group, so groups can safely be evolved concurrently.
+    // Group sizes vary by orders of magnitude, hence the dynamic schedule.
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+ : gal_counter, dead_gals)
+#endif
+    for (int i_fof = 0; i_fof < NFof; i_fof++) {
+        // First check to see if this FOF group is empty.  If it is then skip it.
+        // Also skip the remaining groups once any thread has hit an ABORT.
+        if ((fof_group[i_fof].FirstOccupiedHalo < 0) || thread_abort_flagged())
+            continue;
+
+        evolve_fof_group(&(fof_group[i_fof]), snapshot, &gal_counter, &dead_gals);
+    }
+
+    check_thread_abort();
 
     if (gal_counter + (run_globals.NGhosts) != NGal) {
         mlog_error("We have not processed the expected number of galaxies...");
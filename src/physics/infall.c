@@ -19,8 +19,8 @@ double gas_infall(fof_group_t* FOFgroup, int snapshot)
     double total_blackholemass = 0.0;
 
     // Calculate the total baryon mass in the FOF group
-    halo = FOFgroup->FirstHalo;
-    central = FOFgroup->FirstOccupiedHalo->Galaxy;
+    halo = fof_first_halo(FOFgroup);
+    central = fof_first_occupied_halo(FOFgroup)->Galaxy;
 
     while (halo != NULL) {
         gal = halo->Galaxy;
@@ -42,7 +42,7 @@ double gas_infall(fof_group_t* FOFgroup, int snapshot)
 
             gal = gal->NextGalInHalo;
         }
-        halo = halo->NextHaloInFOFGroup;
+        halo = next_halo_in_fof_group(halo);
     }
 
     total_baryons = total_stellarmass + total_hotgas + total_coldgas + total_ejectedgas + total_blackholemass;
@@ -1,6 +1,28 @@
 #include "meraxes.h"
 #include <math.h>
 
+static galaxy_t* find_merger_mother(galaxy_t* sat)
+{
+    // The merger "mother" is the most massive galaxy associated with a merger
+    // event.  It is the same for every merger in a halo at a given snapshot and
+    // so is only searched for once.  The cached value is invalidated by
+    // connect_galaxy_and_halo() whenever the halo's galaxy list changes.
+    halo_t* halo = sat->Halo;
+
+    if (halo->MergerMother == NULL) {
+        galaxy_t* cur_gal = sat->FirstGalInHalo;
+        galaxy_t* mother = cur_gal;
+        while (cur_gal != NULL) {
+            if ((cur_gal->OldType < 2) && (cur_gal->OldType > -1) && (cur_gal->Len > mother->Len))
+                mother = cur_gal;
+            cur_gal = cur_gal->NextGalInHalo;
+        }
+        halo->MergerMother = mother;
+    }
+
+    return halo->MergerMother;
+}
+
 double calculate_merging_time(galaxy_t* orphan, int snapshot)
 {
     // TODO: What should we do about FOF properties here?  Do we need to use the
@@ -10,7 +32,6 @@ double calculate_merging_time(galaxy_t* orphan, int snapshot)
     galaxy_t* parent = NULL;
     galaxy_t* mother = NULL;
     galaxy_t* sat = NULL;
-    galaxy_t* cur_gal = NULL;
     double coulomb;
     double mergtime;
     double sat_mass;
@@ -56,13 +77,7 @@ double calculate_merging_time(galaxy_t* orphan, int snapshot)
     // with the merger event.  It's possible that there are >2 halos
     // participating in this merger but we want to use the most massive one in
     // the coulomb logarithm.
-    cur_gal = sat->FirstGalInHalo;
-    mother = cur_gal;
-    while (cur_gal != NULL) {
-        if ((cur_gal->OldType < 2) && (cur_gal->OldType > -1) && (cur_gal->Len > mother->Len))
-            mother = cur_gal;
-        cur_gal = cur_gal->NextGalInHalo;
-    }
+    mother = find_merger_mother(sat);
 
     coulomb = log1p((double)(mother->Len) / (double)(sat->Len));
 
@@ -92,7 +107,7 @@ double calculate_merging_time(galaxy_t* orphan, int snapshot)
     sat_rad /= (1 + run_globals.ZZ[snapshot - 1]);
 
     // TODO: Should this be parent or mother???
-    orphan->MergerStartRadius = sat_rad / mother->Rvir;
+    orphan->Aux->MergerStartRadius = sat_rad / mother->Rvir;
 
     if (sat_rad > mother->Rvir)
         sat_rad = mother->Rvir;
@@ -173,15 +188,15 @@ void merge_with_target(galaxy_t* gal, int* dead_gals, int snapshot)
     parent->BHemissivity += gal->BHemissivity;
     parent->BlackHoleMass += gal->BlackHoleMass;
     parent->EffectiveBHM += gal->EffectiveBHM;
-    parent->mwmsa_num += gal->mwmsa_num;
-    parent->mwmsa_denom += gal->mwmsa_denom;
+    parent->Aux->mwmsa_num += gal->Aux->mwmsa_num;
+    parent->Aux->mwmsa_denom += gal->Aux->mwmsa_denom;
     parent->MergerBurstMass += gal->MergerBurstMass;
 
     for (int ii = 0; ii < N_HISTORY_SNAPS; ii++)
-        parent->NewStars[ii] += gal->NewStars[ii];
+        parent->Aux->NewStars[ii] += gal->Aux->NewStars[ii];
 
     for (int ii = 0; ii < N_HISTORY_SNAPS; ii++)
-        parent->NewMetals[ii] += gal->NewMetals[ii];
+        parent->Aux->NewMetals[ii] += gal->Aux->NewMetals[ii];
 
 #ifdef CALC_MAGS
     merge_luminosities(parent, gal);
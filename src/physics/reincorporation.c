@@ -16,7 +16,7 @@ void reincorporate_ejected_gas(galaxy_t* gal)
 
     if (gal->EjectedGas > 0 && ReincorporationEff > 0.) {
         int ReincorporationModel = run_globals.params.physics.ReincorporationModel;
-        fof_group_t* fof_group = gal->Halo->FOFGroup;
+        fof_group_t* fof_group = halo_fof_group(gal->Halo);
         double reincorporated = 0.;
         double t_dyn = fof_group->Rvir / fof_group->Vvir;
         double t_rein;
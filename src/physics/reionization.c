@@ -104,7 +104,7 @@ static double precomputed_Mcrit_modifier(galaxy_t* gal, double Mvir, int snapsho
     return pow(2.0, -Mvir_crit / Mvir);
 }
 
-double gnedin2000_modifer(double Mvir, double redshift)
+static double gnedin2000_mass_scale(double redshift)
 {
     // NOTE THAT PART OF THIS CODE IS COPIED VERBATIM FROM THE CROTON ET AL. 2006 SEMI-ANALYTIC MODEL.
     // WITH A COUPLE OF BUGFIXES SO THAT EQUATIONS MATCH KRAVTSOV+ 2004
@@ -119,8 +119,6 @@ double gnedin2000_modifer(double Mvir, double redshift)
     double Mfiltering;
     double Mjeans;
     double Mchar;
-    double mass_to_use;
-    double modifier;
 
     a0 = 1.0 / (1.0 + run_globals.params.physics.ReionGnedin_z0);
     ar = 1.0 / (1.0 + run_globals.params.physics.ReionGnedin_zr);
@@ -151,19 +149,36 @@ double gnedin2000_modifer(double Mvir, double redshift)
     Mchar = Mcool(redshift);
 
     // we use the maximum of Mfiltering and Mchar
-    mass_to_use = (Mfiltering > Mchar) ? Mfiltering : Mchar;
-    modifier = 1.0 / pow(1.0 + 0.26 * (mass_to_use / Mvir), 3.0);
+    return (Mfiltering > Mchar) ? Mfiltering : Mchar;
+}
 
-    return modifier;
+double gnedin2000_modifer(double Mvir, double redshift)
+{
+    double mass_to_use = gnedin2000_mass_scale(redshift);
+
+    return 1.0 / pow(1.0 + 0.26 * (mass_to_use / Mvir), 3.0);
+}
+
+//! The redshift dependent mass scale of the chosen global reionization modifier
+double reionization_mass_scale(double redshift)
+{
+    switch (run_globals.params.physics.Flag_ReionizationModifier) {
+    case 1:
+        return sobacchi_Mvir_min(redshift);
+
+    case 2:
+        return gnedin2000_mass_scale(redshift);
+
+    default:
+        return 0.0;
+    }
 }
 
 double reionization_modifier(galaxy_t* gal, double Mvir, int snapshot)
 {
-    double redshift;
+    const snapshot_consts_t* consts;
     double modifier;
 
-    redshift = run_globals.ZZ[snapshot];
-
     if ((run_globals.params.ReionUVBFlag) && (run_globals.params.Flag_PatchyReion)) {
         modifier = tocf_modifier(gal, Mvir);
         return modifier;
@@ -172,12 +187,14 @@ double reionization_modifier(galaxy_t* gal, double Mvir, int snapshot)
     switch (run_globals.params.physics.Flag_ReionizationModifier) {
     case 1:
         // Sobacchi & Mesinger 2013 global reionization scheme
-        modifier = sobacchi2013_modifier(Mvir, redshift);
+        consts = get_snapshot_consts(snapshot);
+        modifier = pow(2.0, -consts->ReionMassScale / Mvir);
         break;
 
     case 2:
         // Gnedin 2000 global reionization modifier
-        modifier = gnedin2000_modifer(Mvir, redshift);
+        consts = get_snapshot_consts(snapshot);
+        modifier = 1.0 / pow(1.0 + 0.26 * (consts->ReionMassScale / Mvir), 3.0);
         break;
 
     case 3:
@@ -16,8 +16,8 @@ static void backfill_ghost_star_formation(galaxy_t* gal, double m_stars, double
                 if (sfr > 0.)
                     add_luminosities(&run_globals.mag_params, gal, snap, metallicity, sfr);
 #endif
-                gal->NewStars[ii] += m_stars;
-                gal->NewMetals[0] += m_stars * metallicity;
+                gal->Aux->NewStars[ii] += m_stars;
+                gal->Aux->NewMetals[0] += m_stars * metallicity;
                 update_galaxy_fesc_vals(gal, m_stars, snap);
                 break;
             }
@@ -58,8 +58,8 @@ void update_reservoirs_from_sf(galaxy_t* gal, double new_stars, int snapshot, SF
             if (sfr > 0.)
                 add_luminosities(&run_globals.mag_params, gal, snapshot, metallicity, sfr);
 #endif
-            gal->NewStars[0] += new_stars;
-            gal->NewMetals[0] += new_stars * metallicity;
+            gal->Aux->NewStars[0] += new_stars;
+            gal->Aux->NewMetals[0] += new_stars * metallicity;
 
             update_galaxy_fesc_vals(gal, new_stars, snapshot);
         }
@@ -90,11 +90,7 @@ void insitu_star_formation(galaxy_t* gal, int snapshot)
         double m_recycled;
         double new_metals;
 
-        double zplus1;
-        double zplus1_n;
-
-        zplus1 = 1.0 + run_globals.ZZ[snapshot];
-        zplus1_n = pow(zplus1, run_globals.params.physics.SfEfficiencyScaling);
+        double zplus1_n = get_snapshot_consts(snapshot)->SfEfficiencyZScaling;
 
         double SfEfficiency = run_globals.params.physics.SfEfficiency;
         double SfCriticalSDNorm = run_globals.params.physics.SfCriticalSDNorm;
@@ -162,54 +158,156 @@ void insitu_star_formation(galaxy_t* gal, int snapshot)
     }
 }
 
+// The Blitz & Rosolowsky (2006) SFR integral over the disk reduces, after
+// scaling radii by reff, to a dimensionless integral of two parameters:
+//   a = pi/2 G sigma_gas0^2 / P0  and  b = pi/2 G sigma_gas0 v_ratio sqrt(sigma_stars0) / P0.
+// We tabulate its log on a regular grid in (log10 a, log10 b) and interpolate
+// bilinearly, falling back to direct quadrature outside of the table.
+#define BR06_P0 4.79e-13 // [Pa]
+#define BR06_X_MAX 5.0 // upper integration limit [reff]
+#define BR06_LOG_MIN -10.0
+#define BR06_DLOG 0.05
+#define BR06_N 401
+#define BR06_TABLE_TOL 1.0e-3 // max allowed relative interpolation error
+#define BR06_WORKSIZE 512
+
+static double br06_table[BR06_N][BR06_N];
+static bool br06_table_ready = false;
+
+// Quadrature workspaces for direct integration (e.g. for b = 0, which is off
+// the log grid), one per OpenMP thread.  Allocated along with the table.
+static gsl_integration_workspace** br06_workspaces = NULL;
+static int br06_n_workspaces = 0;
+
 struct FR_parameters {
     double a;
     double b;
-    double c;
-    double d;
 };
 
-static double integrand_p_dependent_SFR(double q, void* gal)
+static double integrand_p_dependent_SFR(double x, void* params)
 {
-    struct FR_parameters* params = (struct FR_parameters*)gal;
+    struct FR_parameters* p = (struct FR_parameters*)params;
 
-    double sigma_gas0 = (params->a);
-    double sigma_stars0 = (params->b);
-    double v_ratio = (params->c);
-    double reff = (params->d);
+    double p_ext = p->a * exp(-2.0 * x) + p->b * exp(-1.5 * x);
+    double fmol = 1.0 / (1.0 + pow(p_ext, -0.92));
 
-    double G_SI = GRAVITY * 1.e-3;
-    double sf_effH = 1.;
+    return x * exp(-x) * fmol;
+}
 
-    double p_ext = M_PI / 2.0 * G_SI * sigma_gas0 * exp(-q / reff) * (sigma_gas0 * exp(-q / reff) + v_ratio * sqrt(sigma_stars0 * exp(-q / reff)));
-    double fmol = 1.0 / (1.0 + pow(p_ext / 4.79e-13, -0.92));
+static double p_dependent_SFR_quad(double a, double b, gsl_integration_workspace* workspace)
+{
+    gsl_function FR;
+    double result, abserr;
+
+    struct FR_parameters parameters = { a, b };
 
-    // double Surface0 = 200. * 1.989e30 / 3.086e16 / 3.086e16;  // 200M_sun/pc^(-2)
-    // sf_effH=sf_effH*(1.+pow(sigma_gas0*exp(-q/reff)/Surface0,0.4));  //Lagos et al. 2011 paper
+    FR.function = &integrand_p_dependent_SFR;
+    FR.params = &parameters;
 
-    double my_integrandR = q * fmol * sigma_gas0 * exp(-q / reff) * sf_effH;
+    gsl_integration_qag(&FR, 0.0, BR06_X_MAX, 1.0e-8, 1.0e-8, BR06_WORKSIZE, GSL_INTEG_GAUSS21, workspace, &result, &abserr);
 
-    return my_integrandR;
+    return result;
 }
 
-static double p_dependent_SFR(double lower_limit, double upper_limit, double sigma_gas0, double sigma_stars0, double v_ratio, double reff)
+static double p_dependent_SFR_direct(double a, double b)
 {
-    static gsl_function FR;
-    static gsl_integration_workspace* workspace;
-    double result, abserr;
-    size_t worksize = 512;
+#ifdef USE_OPENMP
+    int i_thread = omp_get_thread_num();
+#else
+    int i_thread = 0;
+#endif
+    assert(i_thread < br06_n_workspaces);
 
-    struct FR_parameters parameters = { sigma_gas0, sigma_stars0, v_ratio, reff };
+    return p_dependent_SFR_quad(a, b, br06_workspaces[i_thread]);
+}
 
-    workspace = gsl_integration_workspace_alloc(worksize);
+static double p_dependent_SFR(double a, double b)
+{
+    if (br06_table_ready && (a > 0.0) && (b > 0.0)) {
+        double xa = (log10(a) - BR06_LOG_MIN) / BR06_DLOG;
+        double xb = (log10(b) - BR06_LOG_MIN) / BR06_DLOG;
 
-    FR.function = &integrand_p_dependent_SFR;
-    FR.params = &parameters;
+        if ((xa >= 0.0) && (xa < BR06_N - 1) && (xb >= 0.0) && (xb < BR06_N - 1)) {
+            int ia = (int)xa;
+            int ib = (int)xb;
+            double fa = xa - ia;
+            double fb = xb - ib;
 
-    gsl_integration_qag(&FR, lower_limit, upper_limit, 1.0e-8, 1.0e-8, worksize, GSL_INTEG_GAUSS21, workspace, &result, &abserr);
-    gsl_integration_workspace_free(workspace);
+            double log_result = (1.0 - fa) * ((1.0 - fb) * br06_table[ia][ib] + fb * br06_table[ia][ib + 1])
+                + fa * ((1.0 - fb) * br06_table[ia + 1][ib] + fb * br06_table[ia + 1][ib + 1]);
 
-    return result;
+            return exp(log_result);
+        }
+    }
+
+    return p_dependent_SFR_direct(a, b);
+}
+
+void init_pressure_dependent_star_formation(void)
+{
+    if (br06_table_ready)
+        return;
+
+    mlog("Tabulating pressure dependent SFR integral...", MLOG_OPEN | MLOG_TIMERSTART);
+
+    if (br06_workspaces == NULL) {
+#ifdef USE_OPENMP
+        br06_n_workspaces = omp_get_max_threads();
+#else
+        br06_n_workspaces = 1;
+#endif
+        br06_workspaces = malloc(sizeof(gsl_integration_workspace*) * br06_n_workspaces);
+        for (int ii = 0; ii < br06_n_workspaces; ii++)
+            br06_workspaces[ii] = gsl_integration_workspace_alloc(BR06_WORKSIZE);
+    }
+
+    gsl_integration_workspace* workspace = br06_workspaces[0];
+    int mpi_rank = run_globals.mpi_rank;
+    int mpi_size = run_globals.mpi_size;
+
+    // Each rank fills a subset of rows, which are then combined
+    memset(br06_table, 0, sizeof(br06_table));
+    for (int ia = mpi_rank; ia < BR06_N; ia += mpi_size)
+        for (int ib = 0; ib < BR06_N; ib++)
+            br06_table[ia][ib] = log(p_dependent_SFR_quad(pow(10.0, BR06_LOG_MIN + ia * BR06_DLOG),
+                pow(10.0, BR06_LOG_MIN + ib * BR06_DLOG), workspace));
+
+    MPI_Allreduce(MPI_IN_PLACE, br06_table, BR06_N * BR06_N, MPI_DOUBLE, MPI_SUM, run_globals.mpi_comm);
+
+    // Validate the interpolation against direct quadrature at the cell centres,
+    // where the bilinear interpolation error is largest
+    br06_table_ready = true;
+    double max_err = 0.0;
+    for (int ia = mpi_rank; ia < BR06_N - 1; ia += mpi_size)
+        for (int ib = 0; ib < BR06_N - 1; ib++) {
+            double a = pow(10.0, BR06_LOG_MIN + (ia + 0.5) * BR06_DLOG);
+            double b = pow(10.0, BR06_LOG_MIN + (ib + 0.5) * BR06_DLOG);
+            double exact = p_dependent_SFR_quad(a, b, workspace);
+            double err = fabs(p_dependent_SFR(a, b) / exact - 1.0);
+            if (err > max_err)
+                max_err = err;
+        }
+
+    MPI_Allreduce(MPI_IN_PLACE, &max_err, 1, MPI_DOUBLE, MPI_MAX, run_globals.mpi_comm);
+
+    if (max_err > BR06_TABLE_TOL) {
+        mlog_error("Max relative error of SFR integral table (%.2e) exceeds tolerance (%.2e).  Using direct integration.",
+            max_err, BR06_TABLE_TOL);
+        br06_table_ready = false;
+    } else
+        mlog("Max relative interpolation error = %.2e", MLOG_MESG, max_err);
+
+    mlog("...done", MLOG_CLOSE | MLOG_TIMERSTOP);
+}
+
+void free_pressure_dependent_star_formation(void)
+{
+    for (int ii = 0; ii < br06_n_workspaces; ii++)
+        gsl_integration_workspace_free(br06_workspaces[ii]);
+    free(br06_workspaces);
+    br06_workspaces = NULL;
+    br06_n_workspaces = 0;
+    br06_table_ready = false;
 }
 
 double pressure_dependent_star_formation(galaxy_t* gal, int snapshot)
@@ -221,7 +319,7 @@ double pressure_dependent_star_formation(galaxy_t* gal, int snapshot)
 
     double SfEfficiency = run_globals.params.physics.SfEfficiency;
     double Y_He = run_globals.params.physics.Y_He;
-    double zplus1_n = pow(1.0 + run_globals.ZZ[snapshot], run_globals.params.physics.SfEfficiencyScaling);
+    double zplus1_n = get_snapshot_consts(snapshot)->SfEfficiencyZScaling;
     run_units_t* units = &(run_globals.units);
     double G_SI = GRAVITY * 1.e-3;
 
@@ -246,7 +344,7 @@ double pressure_dependent_star_formation(galaxy_t* gal, int snapshot)
 
         if (sigma_gas0 > 0.0) {
             double p_ext = M_PI / 2.0 * G_SI * sigma_gas0 * (sigma_gas0 + v_ratio * sqrt(sigma_stars0));
-            double MSFR = 1.0 / (1.0 + pow(p_ext / 4.79e-13, -0.92));
+            double MSFR = 1.0 / (1.0 + pow(p_ext / BR06_P0, -0.92));
             gal->H2Frac = MSFR; // Molecular hydrogen fraction, f_(H2Mass)
 
             if ((MSFR < 0.0) || (MSFR > 1.0)) {
@@ -256,7 +354,9 @@ double pressure_dependent_star_formation(galaxy_t* gal, int snapshot)
 
             // Bigiel+11 SF law
             // TODO: PUT THIS BACK!
-            MSFRR = p_dependent_SFR(0, 5 * reff, sigma_gas0, sigma_stars0, v_ratio, reff);
+            double a = M_PI / 2.0 * G_SI * sigma_gas0 * sigma_gas0 / BR06_P0;
+            double b = M_PI / 2.0 * G_SI * sigma_gas0 * v_ratio * sqrt(sigma_stars0) / BR06_P0;
+            MSFRR = reff * reff * sigma_gas0 * p_dependent_SFR(a, b);
             gal->H2Mass = 2. * M_PI * MSFRR * 1.0e3 / units->UnitMass_in_g; // Molecular hydrogen mass
             if (gal->H2Mass > (1. - Y_He) * gal->ColdGas)
                 gal->H2Mass = (1. - Y_He) * gal->ColdGas;
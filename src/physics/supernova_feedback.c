@@ -15,7 +15,7 @@ void update_reservoirs_from_sn_feedback(galaxy_t* gal, double m_reheat, double m
     if (gal->ghost_flag)
         central = gal;
     else
-        central = gal->Halo->FOFGroup->FirstOccupiedHalo->Galaxy;
+        central = fof_first_occupied_halo(halo_fof_group(gal->Halo))->Galaxy;
 
     gal->StellarMass -= m_recycled;
     // N.B. Stellar metallicity does not work properly. Metals are generated by
@@ -123,23 +123,22 @@ static inline double calc_ejected_mass(
 static inline double calc_sn_reheat_eff(galaxy_t *gal, int snapshot)
 {
     double Vmax = gal->Vmax;    // Vmax is in a unit of km/s
-    double zplus1 = 1. + run_globals.ZZ[snapshot];
+    double z_scaling = get_snapshot_consts(snapshot)->SnReheatZScaling;
     physics_params_t *params = &run_globals.params.physics;
     int SnModel = params->SnModel;
-    double SnReheatRedshiftDep = params->SnReheatRedshiftDep;
     double SnReheatEff = params->SnReheatEff;
     double SnReheatScaling = params->SnReheatScaling;
     double SnReheatNorm = params->SnReheatNorm;
     double SnReheatLimit = params->SnReheatLimit;
     switch (SnModel) {
     case 1:    // Guo et al. 2011 with redshift dependence
-        SnReheatEff *= pow(zplus1/4., SnReheatRedshiftDep) \
+        SnReheatEff *= z_scaling \
                        *(.5 + pow(Vmax/SnReheatNorm, -SnReheatScaling));
         break;
     case 2:    // Muratov et al. 2015
         if (Vmax < SnReheatNorm)
             SnReheatScaling = params->SnReheatScaling2;
-        SnReheatEff *= pow(zplus1/4., SnReheatRedshiftDep)*pow(Vmax/SnReheatNorm, -SnReheatScaling);
+        SnReheatEff *= z_scaling*pow(Vmax/SnReheatNorm, -SnReheatScaling);
         break;
     default:
         mlog_error("Unknonw SnModel!");
@@ -156,23 +155,22 @@ static inline double calc_sn_reheat_eff(galaxy_t *gal, int snapshot)
 static inline double calc_sn_ejection_eff(galaxy_t *gal, int snapshot)
 {
     double Vmax = gal->Vmax;    // Vmax is in a unit of km/s
-    double zplus1 = 1. + run_globals.ZZ[snapshot];
+    double z_scaling = get_snapshot_consts(snapshot)->SnEjectionZScaling;
     physics_params_t *params = &run_globals.params.physics;
     int SnModel = params->SnModel;
-    double SnEjectionRedshiftDep = params->SnEjectionRedshiftDep;
     double SnEjectionEff = params->SnEjectionEff;
     double SnEjectionScaling = params->SnEjectionScaling;
     double SnEjectionNorm = params->SnEjectionNorm;
     switch (SnModel) {
     case 1:    // Guo et al. 2011 with redshift dependence
-        SnEjectionEff *= pow(zplus1/4., SnEjectionRedshiftDep) \
+        SnEjectionEff *= z_scaling \
                          *(.5 + pow(Vmax/SnEjectionNorm, -SnEjectionScaling));
         break;
     case 2:
         // Use the same value with that is used for the mass loading
         if (Vmax < SnEjectionNorm)
             SnEjectionScaling = params->SnEjectionScaling2;
-        SnEjectionEff *= pow(zplus1/4., SnEjectionRedshiftDep) \
+        SnEjectionEff *= z_scaling \
                          *pow(Vmax/SnEjectionNorm, -SnEjectionScaling);
         break;
     default:
@@ -198,22 +196,10 @@ void delayed_supernova_feedback(galaxy_t* gal, int snapshot)
     // If we are at snapshot < N_HISTORY_SNAPS-1 then only try to look back to snapshot 0
     int n_bursts = (snapshot >= N_HISTORY_SNAPS) ? N_HISTORY_SNAPS : snapshot;
 
-    // Loop through each of the last `N_HISTORY_SNAPS` recorded stellar mass
-    // bursts and calculate the amount of energy and mass that they will release
-    // in the current time step.
-    for (int i_burst = 1; i_burst < n_bursts; i_burst++) {
-        double m_stars = gal->NewStars[i_burst];
-
-        // Only need to do this if any stars formed in this history bin
-        if (m_stars > 1e-10) {
-            double metallicity = calc_metallicity(m_stars, gal->NewMetals[i_burst]);
-            // Calculate recycled mass and metals by yield tables
-            m_recycled += m_stars * get_recycling_fraction(i_burst, metallicity);
-            new_metals += m_stars * get_metal_yield(i_burst, metallicity);
-            // Calculate SNII energy
-            sn_energy += get_SN_energy(i_burst, metallicity)*m_stars;
-        }
-    }
+    // Calculate the amount of energy and mass that each of the last
+    // `N_HISTORY_SNAPS` recorded stellar mass bursts will release in the
+    // current time step.
+    get_SN_history_feedback(gal->Aux->NewStars, gal->Aux->NewMetals, n_bursts, &m_recycled, &new_metals, &sn_energy);
 
     m_reheat = calc_sn_reheat_eff(gal, snapshot)*sn_energy/get_total_SN_energy();
     sn_energy *= calc_sn_ejection_eff(gal, snapshot);
@@ -229,7 +215,7 @@ void delayed_supernova_feedback(galaxy_t* gal, int snapshot)
 
     // how much mass is ejected due to this star formation episode?
     if (!gal->ghost_flag)
-        fof_Vvir = gal->Halo->FOFGroup->Vvir;
+        fof_Vvir = halo_fof_group(gal->Halo)->Vvir;
     else
         fof_Vvir = -1;
 
@@ -307,7 +293,7 @@ void contemporaneous_supernova_feedback(
     assert(*new_metals >= 0);
 
     // how much mass is ejected due to this star formation episode? (ala Croton+ 2006)
-    *m_eject = calc_ejected_mass(m_reheat, sn_energy, gal->Vvir, gal->Halo->FOFGroup->Vvir);
+    *m_eject = calc_ejected_mass(m_reheat, sn_energy, gal->Vvir, halo_fof_group(gal->Halo)->Vvir);
 
     assert(*m_reheat >= 0);
     assert(*m_eject >= 0);
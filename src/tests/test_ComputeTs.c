@@ -0,0 +1,264 @@
+#define _MAIN
+#include <criterion/criterion.h>
+#include <meraxes.h>
+
+// This gives us access to the smoothed SFR grid accessors and the X-ray heating functions
+#include "../core/ComputeTs.c"
+
+#define TEST_N_FILTER_STEPS 40
+#define TEST_N_CELLS 4096
+
+static unsigned int lcg_state;
+
+static double lcg_uniform(void)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return (double)(lcg_state >> 8) / (double)(1u << 24);
+}
+
+static void setup_evolve(double zp)
+{
+    int mpi_initialised;
+
+    // kappa_10_elec and kappa_10_pH broadcast their tables
+    MPI_Initialized(&mpi_initialised);
+    if (!mpi_initialised)
+        MPI_Init(NULL, NULL);
+    run_globals.mpi_comm = MPI_COMM_SELF;
+    run_globals.mpi_rank = 0;
+    run_globals.mpi_size = 1;
+
+    run_globals.params.TsNumFilterSteps = TEST_N_FILTER_STEPS;
+    run_globals.params.Flag_SeparateQSOXrays = 0;
+    run_globals.params.physics.SpecIndexXrayGal = 1.0;
+    run_globals.params.Hubble_h = 0.678;
+    run_globals.params.OmegaM = 0.308;
+    run_globals.params.OmegaLambda = 0.692;
+    run_globals.params.OmegaR = 0.0;
+    run_globals.params.BaryonFrac = 0.157;
+    run_globals.params.physics.Y_He = 0.24;
+
+    // The tables shipped in input/ (found relative to this file)
+    char dir[STRLEN];
+    strncpy(dir, __FILE__, STRLEN - 1);
+    dir[STRLEN - 1] = '\0';
+    char* slash = strrchr(dir, '/');
+    if (slash != NULL)
+        *slash = '\0';
+    else
+        strcpy(dir, ".");
+    snprintf(run_globals.params.TablesForXHeatingDir, STRLEN, "%s/../../input/21cmFAST-tables", dir);
+
+    kappa_10(1.0, 1);
+    kappa_10_elec(1.0, 1);
+    kappa_10_pH(1.0, 1);
+
+    zpp_edge = calloc(TEST_N_FILTER_STEPS, sizeof(double));
+    sum_lyn = calloc(TEST_N_FILTER_STEPS, sizeof(double));
+    zpp_weight_GAL = calloc(TEST_N_FILTER_STEPS, sizeof(double));
+    zpp_weight_QSO = calloc(TEST_N_FILTER_STEPS, sizeof(double));
+    lya_weight = calloc(TEST_N_FILTER_STEPS, sizeof(double));
+
+    // A light-cone running back from z' with a Lyman-n contribution that
+    // switches off part of the way back (as in `_ComputeTs`)
+    for (int R_ct = 0; R_ct < TEST_N_FILTER_STEPS; R_ct++) {
+        zpp_edge[R_ct] = zp + 0.15 * (R_ct + 1);
+        sum_lyn[R_ct] = (R_ct < 25) ? 1e-22 * (1.0 + R_ct) : 0.0;
+    }
+
+    NO_LIGHT = 0;
+    growth_factor_zp = dicke(zp);
+    dgrowth_factor_dzp = ddicke_dz(zp);
+    dt_dzp = dtdz((float)zp);
+    dt_dzpp = dtdz((float)zpp_edge[TEST_N_FILTER_STEPS - 1]);
+    init_zpp_weights((float)zp);
+}
+
+static void teardown_evolve(void)
+{
+    free(lya_weight);
+    free(zpp_weight_QSO);
+    free(zpp_weight_GAL);
+    free(sum_lyn);
+    free(zpp_edge);
+    kappa_10_pH(1.0, 2);
+    kappa_10_elec(1.0, 2);
+    kappa_10(1.0, 2);
+}
+
+// The documented tolerance for TsFloatSmoothedSFR is exact agreement: the
+// single precision grids hold the filtered SFR exactly as the FFT produced it,
+// and the unit conversion is applied on reading.  Here the Tk_box and TS_box
+// values of a set of cells evolved with either storage mode are compared with
+// those evolved from the SFR converted as in the original double precision code.
+// The SFRs passed to evolveInt are also compared, as a change in the order of
+// the unit conversion is mostly rounded away in the single precision boxes.
+Test(ComputeTs, float_smoothed_sfr_matches_double)
+{
+    double zp = 12.0;
+    double dzp = -0.1;
+    int n_vals = TEST_N_CELLS * TEST_N_FILTER_STEPS;
+
+    setup_evolve(zp);
+
+    float* sfr_filtered = malloc(sizeof(float) * n_vals);
+    double* grid_double = malloc(sizeof(double) * n_vals);
+    float* grid_float = malloc(sizeof(float) * n_vals);
+    float* Tk[3], *TS[3];
+    for (int i_mode = 0; i_mode < 3; i_mode++) {
+        Tk[i_mode] = malloc(sizeof(float) * TEST_N_CELLS);
+        TS[i_mode] = malloc(sizeof(float) * TEST_N_CELLS);
+    }
+
+    // Typical Meraxes internal units and a ~1 Mpc cell
+    run_units_t units = { .UnitMass_in_g = 1.989e43, .UnitTime_in_s = 3.08568e19, .UnitLength_in_cm = 3.08568e24 };
+    double pixel_volume = pow(100.0 / 0.678 / 128.0, 3);
+    sfr_conversion_t conv = {
+        .pixel_volume = pixel_volume,
+        .mass_rate_unit = units.UnitMass_in_g / units.UnitTime_in_s,
+        .volume_unit = pow(units.UnitLength_in_cm, -3.),
+    };
+
+    // Chosen so that X-ray heating dominates the temperature change
+    const_zp_prefactor_GAL = 1e63;
+
+    lcg_state = 42u;
+
+    // Filtered SFRs spanning several decades (including empty cells)
+    for (int ii = 0; ii < n_vals; ii++)
+        sfr_filtered[ii] = (lcg_uniform() < 0.1) ? 0.0f : (float)(1e-6 * pow(10.0, 6.0 * lcg_uniform()));
+
+    run_globals.params.TsFloatSmoothedSFR = 0;
+    for (int ii = 0; ii < n_vals; ii++)
+        set_smoothed_sfr(grid_double, ii, sfr_filtered[ii], &conv);
+
+    run_globals.params.TsFloatSmoothedSFR = 1;
+    for (int ii = 0; ii < n_vals; ii++)
+        set_smoothed_sfr(grid_float, ii, sfr_filtered[ii], &conv);
+
+    double freq_int_heat[TEST_N_FILTER_STEPS], freq_int_ion[TEST_N_FILTER_STEPS], freq_int_lya[TEST_N_FILTER_STEPS];
+    for (int R_ct = 0; R_ct < TEST_N_FILTER_STEPS; R_ct++) {
+        freq_int_heat[R_ct] = 1e-21 * (1.0 + lcg_uniform());
+        freq_int_ion[R_ct] = 3e-32 * (1.0 + lcg_uniform());
+        freq_int_lya[R_ct] = 1e-15 * (1.0 + lcg_uniform());
+    }
+
+    double max_heating = 0.0;
+    int n_sfr_mismatch[3] = { 0, 0, 0 };
+    for (int ii = 0; ii < TEST_N_CELLS; ii++) {
+        float delta = (float)(2.0 * lcg_uniform() - 0.5);
+        float x_e_init = (float)(1e-4 + 1e-2 * lcg_uniform());
+        float Tk_init = (float)(5.0 + 50.0 * lcg_uniform());
+        int i_R0 = ii * TEST_N_FILTER_STEPS;
+
+        double SFR_ref[TEST_N_FILTER_STEPS];
+        for (int i_mode = 0; i_mode < 3; i_mode++) {
+            double SFR[TEST_N_FILTER_STEPS], ans[2], dansdz[20];
+            float x_e = x_e_init;
+            float curr_xalpha;
+
+            if (i_mode == 0) {
+                // The conversion as written in the original code
+                for (int R_ct = 0; R_ct < TEST_N_FILTER_STEPS; R_ct++)
+                    SFR[R_ct] = ( sfr_filtered[i_R0 + R_ct] / pixel_volume )
+                        * (units.UnitMass_in_g / units.UnitTime_in_s) * pow( units.UnitLength_in_cm, -3. )/ SOLAR_MASS;
+            } else {
+                run_globals.params.TsFloatSmoothedSFR = (i_mode == 2);
+                get_smoothed_sfr_cell((i_mode == 2) ? (void*)grid_float : (void*)grid_double, i_R0, TEST_N_FILTER_STEPS, &conv, SFR);
+            }
+
+            Tk[i_mode][ii] = Tk_init;
+            ans[0] = x_e;
+            ans[1] = Tk_init;
+            evolveInt((float)zp, delta, SFR, SFR, freq_int_heat, freq_int_ion, freq_int_lya,
+                freq_int_heat, freq_int_ion, freq_int_lya, 0, ans, dansdz);
+            TS[i_mode][ii] = update_Ts_cell(zp, dzp, delta, dansdz, &x_e, &Tk[i_mode][ii], &curr_xalpha);
+
+            if (i_mode == 0)
+                memcpy(SFR_ref, SFR, sizeof(SFR));
+            else if (memcmp(SFR, SFR_ref, sizeof(SFR)) != 0)
+                n_sfr_mismatch[i_mode]++;
+
+            if (i_mode == 0)
+                max_heating = fmax(max_heating, fabs(dansdz[3] * dzp));
+        }
+    }
+
+    // Make sure the SFR actually matters here
+    cr_expect(max_heating > 1.0, "Max X-ray heating in the test cells = %g K", max_heating);
+
+    const char* mode_names[3] = { "", "double", "float" };
+    for (int i_mode = 1; i_mode < 3; i_mode++) {
+        cr_expect(n_sfr_mismatch[i_mode] == 0, "%d cells see a different SFR with %s smoothed SFR grids", n_sfr_mismatch[i_mode], mode_names[i_mode]);
+        cr_expect(memcmp(Tk[i_mode], Tk[0], sizeof(float) * TEST_N_CELLS) == 0, "Tk_box differs with %s smoothed SFR grids", mode_names[i_mode]);
+        cr_expect(memcmp(TS[i_mode], TS[0], sizeof(float) * TEST_N_CELLS) == 0, "TS_box differs with %s smoothed SFR grids", mode_names[i_mode]);
+    }
+
+    for (int i_mode = 0; i_mode < 3; i_mode++) {
+        free(TS[i_mode]);
+        free(Tk[i_mode]);
+    }
+    free(grid_float);
+    free(grid_double);
+    free(sfr_filtered);
+    teardown_evolve();
+}
+
+#define TEST_TAUX_N_NU 32
+
+// The tabulated nu_tau_one (TsTauXTableNNu) against the direct root solve.  Both
+// roots carry the 2% tolerance of the direct solve, hence the tolerance here.
+#define TAUX_TABLE_NU_RTOL 0.04
+
+Test(ComputeTs, tabulated_nu_tau_one_matches_direct)
+{
+    double ZZ[2] = { 14.0, 12.0 };
+    double zp = ZZ[1];
+    double zpp_list[TEST_N_FILTER_STEPS];
+    double x_e_vals[5] = { 2e-4, 1e-2, 0.1, 0.5, 0.9 };
+    double max_rel_diff = 0.0;
+    int snapshot = 1;
+
+    run_globals.params.TsNumFilterSteps = TEST_N_FILTER_STEPS;
+    run_globals.params.TsTauXTableNNu = TEST_TAUX_N_NU;
+    run_globals.params.Hubble_h = 0.678;
+    run_globals.params.OmegaM = 0.308;
+    run_globals.params.OmegaLambda = 0.692;
+    run_globals.params.OmegaR = 0.0;
+    run_globals.params.BaryonFrac = 0.157;
+    run_globals.params.physics.Y_He = 0.24;
+    run_globals.params.physics.ReionEfficiency = 20.0;
+    run_globals.ZZ = ZZ;
+    stored_fcoll[0] = 1e-5;
+    stored_fcoll[1] = 1e-4;
+
+    tauX_table = calloc(TEST_TAUX_N_NU * TEST_N_FILTER_STEPS, sizeof(double));
+
+    // Shells out to (1+z'') = 1.6 (1+z'), as for the largest X-ray filtering radii
+    for (int R_ct = 0; R_ct < TEST_N_FILTER_STEPS; R_ct++)
+        zpp_list[R_ct] = (1 + zp) * pow(1.6, (R_ct + 1.0) / TEST_N_FILTER_STEPS) - 1;
+
+    tauX_table_n_fallbacks = 0;
+    for (int i_x_e = 0; i_x_e < 5; i_x_e++) {
+        x_e_ave = x_e_vals[i_x_e];
+        tabulate_tauX(0, TEST_TAUX_N_NU, zp, zpp_list, x_e_ave, snapshot);
+
+        for (int R_ct = 0; R_ct < TEST_N_FILTER_STEPS; R_ct++) {
+            double nu_direct = nu_tau_one(zp, zpp_list[R_ct], x_e_ave, stored_fcoll[1], 0.9, snapshot);
+            double nu_table = nu_tau_one_tabulated(R_ct, zp, zpp_list[R_ct], x_e_ave, stored_fcoll[1], 0.9, snapshot);
+
+            cr_assert(isfinite(nu_table) && (nu_table > 0));
+            max_rel_diff = fmax(max_rel_diff, fabs(nu_table / nu_direct - 1.0));
+        }
+    }
+
+    cr_expect(max_rel_diff <= TAUX_TABLE_NU_RTOL, "Max relative difference in nu_tau_one from the tauX table = %g (tolerance %g)",
+        max_rel_diff, TAUX_TABLE_NU_RTOL);
+
+    // Otherwise the comparison above says nothing about the table
+    cr_expect(tauX_table_n_fallbacks == 0, "nu_tau_one_tabulated fell back to nu_tau_one for %llu of %d roots",
+        tauX_table_n_fallbacks, 5 * TEST_N_FILTER_STEPS);
+
+    free(tauX_table);
+    tauX_table = NULL;
+}
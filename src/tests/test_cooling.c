@@ -0,0 +1,65 @@
+#define _MAIN
+#include <criterion/criterion.h>
+#include <meraxes.h>
+
+// This gives us access to the static functions
+#include "../core/cooling.c"
+
+// The lookup on the resampled grid should reproduce the original log space
+// interpolation of the SD93 tables to rounding
+#define COOLING_RATE_RTOL 1e-12
+
+static void setup(void)
+{
+    int mpi_initialised;
+
+    // read_cooling_functions broadcasts the tables
+    MPI_Initialized(&mpi_initialised);
+    if (!mpi_initialised)
+        MPI_Init(NULL, NULL);
+    run_globals.mpi_comm = MPI_COMM_SELF;
+    run_globals.mpi_rank = 0;
+    run_globals.mpi_size = 1;
+
+    // The tables shipped in input/ (found relative to this file)
+    char dir[STRLEN];
+    strncpy(dir, __FILE__, STRLEN - 1);
+    dir[STRLEN - 1] = '\0';
+    char* slash = strrchr(dir, '/');
+    if (slash != NULL)
+        *slash = '\0';
+    else
+        strcpy(dir, ".");
+    snprintf(run_globals.params.CoolingFuncsDir, STRLEN, "%s/../../input/cooling_functions", dir);
+
+    read_cooling_functions();
+}
+
+Test(cooling, matches_log_space_interpolation, .init = setup)
+{
+    // `interpolate_log_cooling_rate` is the original interpolation of the
+    // tables, which used to be returned as pow(10, rate).  We sweep the whole
+    // table (including just around 10^4 K, where the rates rise by several
+    // orders of magnitude over a couple of tabulated temperatures) as well as
+    // outside of it in both temperature and metallicity.
+    double max_rel_diff = 0.0;
+    double worst_logT = 0.0, worst_logZ = 0.0;
+
+    for (int i_t = 0; i_t <= 4800; i_t++) {
+        double logTemp = 3.9 + 0.001 * i_t;
+        for (int i_z = 0; i_z <= 200; i_z++) {
+            double logZ = -8.0 + 0.0431 * i_z;
+            double expected = pow(10, interpolate_log_cooling_rate(logTemp, logZ));
+            double rate = interpolate_cooling_rate(logTemp, logZ);
+            double rel_diff = fabs(rate - expected) / expected;
+            if (rel_diff > max_rel_diff) {
+                max_rel_diff = rel_diff;
+                worst_logT = logTemp;
+                worst_logZ = logZ;
+            }
+        }
+    }
+
+    cr_expect(max_rel_diff < COOLING_RATE_RTOL, "Max relative difference = %g at logT = %g, logZ = %g (tolerance %g)",
+        max_rel_diff, worst_logT, worst_logZ, COOLING_RATE_RTOL);
+}
@@ -0,0 +1,728 @@
+#define _MAIN
+#include <criterion/criterion.h>
+#include <meraxes.h>
+
+// This gives us access to the static functions
+#include "../core/find_HII_bubbles.c"
+
+#define TEST_GRID_DIM 8
+#define TEST_N_STEPS 6
+#define TEST_N_CELLS (TEST_GRID_DIM * TEST_GRID_DIM * TEST_GRID_DIM)
+#define TEST_N_PADDED (TEST_GRID_DIM * TEST_GRID_DIM * 2 * (TEST_GRID_DIM / 2 + 1))
+
+static const filtered_field_index_t all_fields = {
+    .n_fields = 5,
+    .deltax = 0,
+    .stars = 1,
+    .sfr = 2,
+    .N_rec = 3,
+    .x_e = 4,
+};
+
+static const filtered_field_index_t base_fields = {
+    .n_fields = 3,
+    .deltax = 0,
+    .stars = 1,
+    .sfr = 2,
+    .N_rec = -1,
+    .x_e = -1,
+};
+
+typedef struct test_outputs_t {
+    float xH[TEST_N_CELLS];
+    float J_21[TEST_N_CELLS];
+    float Gamma12[TEST_N_CELLS];
+    float z_re[TEST_N_CELLS];
+    float r_bubble[TEST_N_CELLS];
+    float z_in[TEST_N_CELLS];
+    float J_21_at_ionization[TEST_N_CELLS];
+} test_outputs_t;
+
+static unsigned int lcg_state;
+
+static float lcg_uniform(void)
+{
+    lcg_state = lcg_state * 1664525u + 1013904223u;
+    return (float)(lcg_state >> 8) / (float)(1u << 24);
+}
+
+// The baseline versions of the clamp and ionisation criterion loops from `_find_HII_bubbles`, prior to the fields
+// being interleaved and the loops vectorised.  These are kept verbatim apart from taking the grids and the step
+// constants as arguments, and act on a separate padded grid for each field as the baseline did.
+
+typedef struct baseline_grids_t {
+    float* deltax_filtered;
+    float* stars_filtered;
+    float* sfr_filtered;
+    float* N_rec_filtered;
+    float* x_e_filtered;
+} baseline_grids_t;
+
+static void baseline_clamp_filtered_fields(baseline_grids_t* grids, int local_nix, int ReionGridDim)
+{
+    float* deltax_filtered = grids->deltax_filtered;
+    float* stars_filtered = grids->stars_filtered;
+    float* sfr_filtered = grids->sfr_filtered;
+    float* N_rec_filtered = grids->N_rec_filtered;
+    float* x_e_filtered = grids->x_e_filtered;
+    int i_padded;
+
+    // Perform sanity checks to account for aliasing effects
+    for (int ix = 0; ix < local_nix; ix++)
+        for (int iy = 0; iy < ReionGridDim; iy++)
+            for (int iz = 0; iz < ReionGridDim; iz++) {
+                i_padded = grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED);
+                ((float*)deltax_filtered)[i_padded] = fmaxf(((float*)deltax_filtered)[i_padded], -1 + REL_TOL);
+                ((float*)stars_filtered)[i_padded] = fmaxf(((float*)stars_filtered)[i_padded], 0.0);
+                ((float*)sfr_filtered)[i_padded] = fmaxf(((float*)sfr_filtered)[i_padded], 0.0);
+
+                if(run_globals.params.Flag_IncludeRecombinations) {
+                    ((float*)N_rec_filtered)[i_padded] = fmaxf(((float*)N_rec_filtered)[i_padded], 0.0);
+                }
+                if(run_globals.params.Flag_IncludeSpinTemp) {
+                    ((float*)x_e_filtered)[i_padded] = fmaxf(((float*)x_e_filtered)[i_padded], 0.0);
+                    ((float*)x_e_filtered)[i_padded] = fminf(((float*)x_e_filtered)[i_padded], 0.999);
+                }
+            }
+}
+
+static void baseline_update_ionisation_state(const ionisation_step_t* step,
+    const baseline_grids_t* grids,
+    int local_nix,
+    int ReionGridDim,
+    float* xH,
+    float* J_21,
+    float* Gamma12,
+    float* z_re,
+    float* r_bubble,
+    float* z_in,
+    float* J_21_at_ionization)
+{
+    const float* deltax_filtered = grids->deltax_filtered;
+    const float* stars_filtered = grids->stars_filtered;
+    const float* sfr_filtered = grids->sfr_filtered;
+    const float* N_rec_filtered = grids->N_rec_filtered;
+    const float* x_e_filtered = grids->x_e_filtered;
+    run_units_t* units = &(run_globals.units);
+    int flag_ReionUVBFlag = run_globals.params.ReionUVBFlag;
+    bool flag_last_filter_step = step->last_step;
+    double R = step->R;
+    double redshift = step->redshift;
+    double pixel_volume = step->pixel_volume;
+    double ReionEfficiency = step->ReionEfficiency;
+    double ReionNionPhotPerBary = step->ReionNionPhotPerBary;
+    double ReionGammaHaloBias = step->ReionGammaHaloBias;
+    double J_21_aux_constant = step->J_21_aux_constant;
+    double Gamma_R_prefactor = step->Gamma_R_prefactor;
+    double density_over_mean, f_coll_stars, sfr_density, electron_fraction;
+    double rec = 0.0;
+    double Gamma_R = 0.0;
+    float J_21_aux = 0;
+    int i_real, i_padded;
+
+    for (int ix = 0; ix < local_nix; ix++)
+        for (int iy = 0; iy < ReionGridDim; iy++)
+            for (int iz = 0; iz < ReionGridDim; iz++) {
+                i_real = grid_index(ix, iy, iz, ReionGridDim, INDEX_REAL);
+                i_padded = grid_index(ix, iy, iz, ReionGridDim, INDEX_PADDED);
+
+                density_over_mean = 1.0 + (double)((float*)deltax_filtered)[i_padded];
+
+                f_coll_stars = (double)((float*)stars_filtered)[i_padded] / (RtoM(R) * density_over_mean)
+                    * (4.0 / 3.0) * M_PI * pow(R, 3.0) / pixel_volume;
+
+                sfr_density = (double)((float*)sfr_filtered)[i_padded] / pixel_volume; // In internal units
+
+                // Calculate the recombinations within the cell
+                if(run_globals.params.Flag_IncludeRecombinations) {
+                    Gamma_R = Gamma_R_prefactor * sfr_density * (units->UnitMass_in_g / units->UnitTime_in_s) * pow( units->UnitLength_in_cm / run_globals.params.Hubble_h, -3. )
+                        *  ReionNionPhotPerBary / PROTONMASS; // Convert pixel volume (Mpc/h)^3 -> (cm)^3
+                    rec = (double)((float*)N_rec_filtered)[i_padded] / density_over_mean;
+                }
+
+                // Account for the partial ionisation of the cell from X-rays
+                if(run_globals.params.Flag_IncludeSpinTemp) {
+                    electron_fraction = 1.0 - ((float*)x_e_filtered)[i_padded];
+                }
+                else {
+                    electron_fraction = 1.0;
+                }
+
+                if (flag_ReionUVBFlag)
+                    J_21_aux = (float)(sfr_density * J_21_aux_constant);
+
+                // Modified reionisation condition, including recombinations and partial ionisations from X-rays
+                // Check if ionised!
+                if (f_coll_stars > ( electron_fraction / ReionEfficiency ) * (1. + rec) ) // IONISED!!!!
+                {
+                    // If it is the first crossing of the ionisation barrier for this cell (largest R), let's record J_21
+                    if (xH[i_real] > REL_TOL) {
+                        if (flag_ReionUVBFlag)
+                            J_21[i_real] = J_21_aux;
+
+                        // Store the ionisation background and the reionisation redshift for each cell
+                        if(run_globals.params.Flag_IncludeRecombinations) {
+                            Gamma12[i_real] = (float)Gamma_R;
+                            if(z_re[i_real] < 0) {
+                                z_re[i_real] = (float)redshift;
+                            }
+                        }
+                    }
+
+                    // Mark as ionised
+                    xH[i_real] = 0;
+
+                    // Record radius
+                    r_bubble[i_real] = (float)R;
+                }
+                // Check if this is the last filtering step.
+                // If so, assign partial ionisations to those cells which aren't fully ionised
+                else if (flag_last_filter_step && (xH[i_real] > REL_TOL))
+                {
+                    xH[i_real] = (float)(electron_fraction - f_coll_stars * ReionEfficiency);
+                    if(xH[i_real] < 0.) {
+                        xH[i_real] = (float)0.;
+                    }
+                    else if (xH[i_real] > 1.0) {
+                        xH[i_real] = (float)1.;
+                    }
+                }
+
+                // Check if new ionisation
+                if ((xH[i_real] < REL_TOL) && (z_in[i_real] < 0)) // New ionisation!
+                {
+                    z_in[i_real] = (float)redshift;
+                    if (flag_ReionUVBFlag)
+                        J_21_at_ionization[i_real] = J_21_aux * (float)ReionGammaHaloBias;
+                }
+            }
+}
+
+static float* baseline_grid(const float* fields, const filtered_field_index_t* field, int i_field)
+{
+    // Split one field (including the padding) out of the interleaved buffer
+    if (i_field < 0)
+        return NULL;
+
+    float* grid = malloc(sizeof(float) * TEST_N_PADDED);
+    for (int ii = 0; ii < TEST_N_PADDED; ii++)
+        grid[ii] = fields[(ptrdiff_t)ii * field->n_fields + i_field];
+
+    return grid;
+}
+
+static baseline_grids_t make_baseline_grids(const float* fields, const filtered_field_index_t* field)
+{
+    baseline_grids_t grids = {
+        .deltax_filtered = baseline_grid(fields, field, field->deltax),
+        .stars_filtered = baseline_grid(fields, field, field->stars),
+        .sfr_filtered = baseline_grid(fields, field, field->sfr),
+        .N_rec_filtered = baseline_grid(fields, field, field->N_rec),
+        .x_e_filtered = baseline_grid(fields, field, field->x_e),
+    };
+    return grids;
+}
+
+static void free_baseline_grids(baseline_grids_t* grids)
+{
+    free(grids->x_e_filtered);
+    free(grids->N_rec_filtered);
+    free(grids->sfr_filtered);
+    free(grids->stars_filtered);
+    free(grids->deltax_filtered);
+}
+
+static void set_test_params(const filtered_field_index_t* field)
+{
+    // The run parameters read by the baseline loops and `make_step`
+    run_globals.params.ReionUVBFlag = field->n_fields > 3;
+    run_globals.params.Flag_IncludeRecombinations = field->N_rec >= 0;
+    run_globals.params.Flag_IncludeSpinTemp = field->x_e >= 0;
+    run_globals.params.ReionRtoMFilterType = 0;
+    run_globals.params.OmegaM = 0.3;
+    run_globals.params.Hubble_h = 0.678;
+    run_globals.RhoCrit = 1.7 * 3.0 / (4.0 * M_PI * 0.3); // so that RtoM(R) = 1.7 R^3
+    run_globals.units.UnitMass_in_g = 1.989e43;
+    run_globals.units.UnitTime_in_s = 3.086e19;
+    run_globals.units.UnitLength_in_cm = 3.086e24;
+}
+
+// Build a synthetic set of (already clamped) filtered fields for each step.  The stars
+// field is sparse and decreases towards smaller radii so that cells ionise at a range of R.
+// Every fourth row is bright enough to be ionised from the first step onwards.
+static float* make_filtered_fields(const filtered_field_index_t* field, bool with_stars)
+{
+    float* fields = calloc((size_t)TEST_N_STEPS * TEST_N_PADDED * field->n_fields, sizeof(float));
+    lcg_state = 12345u;
+
+    for (int i_step = 0; i_step < TEST_N_STEPS; i_step++) {
+        float* step_fields = fields + (ptrdiff_t)i_step * TEST_N_PADDED * field->n_fields;
+        for (int ix = 0; ix < TEST_GRID_DIM; ix++)
+            for (int iy = 0; iy < TEST_GRID_DIM; iy++)
+                for (int iz = 0; iz < TEST_GRID_DIM; iz++) {
+                    float* cell = step_fields
+                        + (ptrdiff_t)grid_index(ix, iy, iz, TEST_GRID_DIM, INDEX_PADDED) * field->n_fields;
+                    cell[field->deltax] = fmaxf(2.0f * lcg_uniform() - 1.0f, -1 + REL_TOL);
+                    float stars = lcg_uniform() < 0.4f ? lcg_uniform() * (float)(TEST_N_STEPS - i_step) : 0.0f;
+                    if (iy % 4 == 0)
+                        stars += 100.0f;
+                    cell[field->stars] = with_stars ? stars : 0.0f;
+                    cell[field->sfr] = with_stars ? 0.1f * stars : 0.0f;
+                    if (field->N_rec >= 0)
+                        cell[field->N_rec] = 0.5f * lcg_uniform();
+                    if (field->x_e >= 0)
+                        cell[field->x_e] = fminf(0.2f * lcg_uniform(), 0.999f);
+                }
+    }
+
+    return fields;
+}
+
+static void init_outputs(test_outputs_t* out)
+{
+    for (int ii = 0; ii < TEST_N_CELLS; ii++) {
+        out->xH[ii] = 1.0f;
+        out->J_21[ii] = 0.0f;
+        out->Gamma12[ii] = 0.0f;
+        out->z_re[ii] = (ii % 5 == 0) ? 13.0f : -1.0f;
+        out->r_bubble[ii] = 0.0f;
+        // some cells were already ionised at an earlier snapshot
+        out->z_in[ii] = (ii % 7 == 0) ? 12.0f : -1.0f;
+        out->J_21_at_ionization[ii] = 0.0f;
+    }
+}
+
+static ionisation_step_t make_step(double R, bool last_step)
+{
+    // The step constants as they are set up in `_find_HII_bubbles`
+    run_units_t* units = &(run_globals.units);
+    ionisation_step_t step = {
+        .R = R,
+        .M_R = RtoM(R),
+        .R3 = pow(R, 3.0),
+        .redshift = 9.5,
+        .pixel_volume = 1.0,
+        .ReionEfficiency = 10.0,
+        .ReionGammaHaloBias = 2.0,
+        .J_21_aux_constant = 3.1 * R,
+        .Gamma_R_prefactor = 0.7 * R,
+        .mass_rate_unit = units->UnitMass_in_g / units->UnitTime_in_s,
+        .inv_volume_unit = pow(units->UnitLength_in_cm / run_globals.params.Hubble_h, -3.),
+        .ReionNionPhotPerBary = 4000.0,
+        .last_step = last_step,
+        .flag_ReionUVBFlag = run_globals.params.ReionUVBFlag,
+        .include_recombinations = run_globals.params.Flag_IncludeRecombinations,
+        .include_spin_temp = run_globals.params.Flag_IncludeSpinTemp,
+    };
+    return step;
+}
+
+static void run_steps(const float* fields, const filtered_field_index_t* field, int first_step, test_outputs_t* out,
+    bool use_convergence_mask, bool baseline)
+{
+    // only pass the optional outputs which are being tracked
+    bool all_outputs = field->n_fields > 3;
+    float* J_21 = all_outputs ? out->J_21 : NULL;
+    float* Gamma12 = all_outputs ? out->Gamma12 : NULL;
+    float* z_re = all_outputs ? out->z_re : NULL;
+    float* J_21_at_ionization = all_outputs ? out->J_21_at_ionization : NULL;
+
+    set_test_params(field);
+
+    double R = 8.0;
+    for (int i_step = 0; i_step < TEST_N_STEPS; i_step++, R /= 1.3) {
+        if (i_step < first_step)
+            continue;
+        bool last_step = (i_step == TEST_N_STEPS - 1);
+        ionisation_step_t step = make_step(last_step ? 1.0 : R, last_step);
+        const float* step_fields = fields + (ptrdiff_t)i_step * TEST_N_PADDED * field->n_fields;
+
+        if (baseline) {
+            baseline_grids_t grids = make_baseline_grids(step_fields, field);
+            baseline_update_ionisation_state(&step, &grids, TEST_GRID_DIM, TEST_GRID_DIM,
+                out->xH, J_21, Gamma12, z_re, out->r_bubble, out->z_in, J_21_at_ionization);
+            free_baseline_grids(&grids);
+        } else {
+            update_ionisation_state(&step, step_fields, field, TEST_GRID_DIM, TEST_GRID_DIM,
+                out->xH, J_21, Gamma12, z_re, out->r_bubble, out->z_in, J_21_at_ionization, use_convergence_mask);
+        }
+    }
+}
+
+static void expect_outputs_match(const test_outputs_t* a, const test_outputs_t* b)
+{
+    cr_expect(memcmp(a->xH, b->xH, sizeof(a->xH)) == 0, "xH differs");
+    cr_expect(memcmp(a->J_21, b->J_21, sizeof(a->J_21)) == 0, "J_21 differs");
+    cr_expect(memcmp(a->Gamma12, b->Gamma12, sizeof(a->Gamma12)) == 0, "Gamma12 differs");
+    cr_expect(memcmp(a->z_re, b->z_re, sizeof(a->z_re)) == 0, "z_re differs");
+    cr_expect(memcmp(a->r_bubble, b->r_bubble, sizeof(a->r_bubble)) == 0, "r_bubble differs");
+    cr_expect(memcmp(a->z_in, b->z_in, sizeof(a->z_in)) == 0, "z_in differs");
+    cr_expect(memcmp(a->J_21_at_ionization, b->J_21_at_ionization, sizeof(a->J_21_at_ionization)) == 0,
+        "J_21_at_ionization differs");
+}
+
+static void check_clamp_against_baseline(const filtered_field_index_t* field)
+{
+    size_t n_values = (size_t)TEST_N_PADDED * field->n_fields;
+    float* fields = malloc(sizeof(float) * n_values);
+
+    lcg_state = 54321u;
+    for (size_t ii = 0; ii < n_values; ii++)
+        fields[ii] = 4.0f * lcg_uniform() - 2.0f;
+
+    set_test_params(field);
+    baseline_grids_t reference = make_baseline_grids(fields, field);
+    baseline_clamp_filtered_fields(&reference, TEST_GRID_DIM, TEST_GRID_DIM);
+
+    clamp_filtered_fields(fields, field, TEST_GRID_DIM, TEST_GRID_DIM);
+    baseline_grids_t clamped = make_baseline_grids(fields, field);
+
+    // N.B. This includes the padding, which must be left untouched
+    size_t grid_size = sizeof(float) * TEST_N_PADDED;
+    cr_expect(memcmp(clamped.deltax_filtered, reference.deltax_filtered, grid_size) == 0, "deltax differs");
+    cr_expect(memcmp(clamped.stars_filtered, reference.stars_filtered, grid_size) == 0, "stars differs");
+    cr_expect(memcmp(clamped.sfr_filtered, reference.sfr_filtered, grid_size) == 0, "sfr differs");
+    if (field->N_rec >= 0)
+        cr_expect(memcmp(clamped.N_rec_filtered, reference.N_rec_filtered, grid_size) == 0, "N_rec differs");
+    if (field->x_e >= 0)
+        cr_expect(memcmp(clamped.x_e_filtered, reference.x_e_filtered, grid_size) == 0, "x_e differs");
+
+    free_baseline_grids(&clamped);
+    free_baseline_grids(&reference);
+    free(fields);
+}
+
+static void check_criterion_against_baseline(const filtered_field_index_t* field)
+{
+    float* fields = make_filtered_fields(field, true);
+    test_outputs_t* vectorised = malloc(sizeof(test_outputs_t));
+    test_outputs_t* reference = malloc(sizeof(test_outputs_t));
+
+    init_outputs(vectorised);
+    init_outputs(reference);
+
+    run_steps(fields, field, 0, vectorised, true, false);
+    run_steps(fields, field, 0, reference, false, true);
+
+    // make sure the test actually covers both ionised and partially ionised cells
+    int n_ionised = 0;
+    for (int ii = 0; ii < TEST_N_CELLS; ii++)
+        n_ionised += (reference->xH[ii] == 0);
+    cr_assert(n_ionised > 0);
+    cr_assert(n_ionised < TEST_N_CELLS);
+
+    expect_outputs_match(vectorised, reference);
+
+    free(reference);
+    free(vectorised);
+    free(fields);
+}
+
+Test(find_HII_bubbles, clamp_matches_baseline)
+{
+    check_clamp_against_baseline(&all_fields);
+    check_clamp_against_baseline(&base_fields);
+}
+
+Test(find_HII_bubbles, criterion_matches_baseline)
+{
+    check_criterion_against_baseline(&all_fields);
+}
+
+Test(find_HII_bubbles, criterion_matches_baseline_without_optional_fields)
+{
+    check_criterion_against_baseline(&base_fields);
+}
+
+Test(find_HII_bubbles, convergence_mask_is_exact)
+{
+    float* fields = make_filtered_fields(&all_fields, true);
+    test_outputs_t* masked = malloc(sizeof(test_outputs_t));
+    test_outputs_t* reference = malloc(sizeof(test_outputs_t));
+
+    // make sure the test actually exercises the mask
+    init_outputs(reference);
+    run_steps(fields, &all_fields, 0, reference, false, false);
+    int n_converged_rows = 0;
+    for (int i_row = 0; i_row < TEST_GRID_DIM * TEST_GRID_DIM; i_row++)
+        n_converged_rows += row_is_converged(TEST_GRID_DIM, reference->xH + i_row * TEST_GRID_DIM,
+            reference->z_in + i_row * TEST_GRID_DIM);
+    cr_assert(n_converged_rows > 0);
+    cr_assert(n_converged_rows < TEST_GRID_DIM * TEST_GRID_DIM);
+
+    init_outputs(masked);
+    init_outputs(reference);
+    run_steps(fields, &all_fields, 0, masked, true, false);
+    run_steps(fields, &all_fields, 0, reference, false, false);
+
+    cr_expect(memcmp(masked, reference, sizeof(test_outputs_t)) == 0);
+
+    free(reference);
+    free(masked);
+    free(fields);
+}
+
+Test(find_HII_bubbles, skip_to_last_step_without_sources_is_exact)
+{
+    float* fields = make_filtered_fields(&all_fields, false);
+    test_outputs_t* skipped = malloc(sizeof(test_outputs_t));
+    test_outputs_t* reference = malloc(sizeof(test_outputs_t));
+
+    init_outputs(skipped);
+    init_outputs(reference);
+
+    run_steps(fields, &all_fields, TEST_N_STEPS - 1, skipped, true, false);
+    run_steps(fields, &all_fields, 0, reference, true, false);
+
+    cr_expect(memcmp(skipped, reference, sizeof(test_outputs_t)) == 0);
+
+    free(reference);
+    free(skipped);
+    free(fields);
+}
+
+Test(find_HII_bubbles, slab_has_ionising_sources)
+{
+    fftwf_complex stars[16] = { 0 };
+    cr_expect(!slab_has_ionising_sources(stars, 16));
+    stars[11] = 1e-30f;
+    cr_expect(slab_has_ionising_sources(stars, 16));
+}
+
+static void filter_ones(fftwf_complex* box, int n_fields, int local_ix_start, int slab_nx, float R, int filter_type)
+{
+    int n_complex = slab_nx * TEST_GRID_DIM * (TEST_GRID_DIM / 2 + 1) * n_fields;
+    for (int ii = 0; ii < n_complex; ii++)
+        box[ii] = 1.0f;
+    filter_many(box, n_fields, local_ix_start, slab_nx, TEST_GRID_DIM, R, filter_type);
+}
+
+Test(find_HII_bubbles, filter_kernel_table_tracks_radius_and_slab)
+{
+    // The kernel table is kept between calls, so it must be rebuilt whenever the radius, filter type or slab changes
+    const int n_complex = TEST_GRID_DIM * TEST_GRID_DIM * (TEST_GRID_DIM / 2 + 1);
+    const int n_half = n_complex / 2;
+    fftwf_complex* first = malloc(sizeof(fftwf_complex) * n_complex);
+    fftwf_complex* again = malloc(sizeof(fftwf_complex) * n_complex * 2);
+
+    run_globals.params.BoxSize = 100.0;
+
+    filter_ones(first, 1, 0, TEST_GRID_DIM, 20.0f, 0);
+    cr_assert(first[0] == 1.0f);
+    cr_assert(crealf(first[n_complex - 1]) < 1.0f);
+
+    filter_ones(again, 1, 0, TEST_GRID_DIM, 5.0f, 0);
+    cr_expect(memcmp(first, again, sizeof(fftwf_complex) * n_complex) != 0);
+
+    filter_ones(again, 1, 0, TEST_GRID_DIM, 20.0f, 2);
+    cr_expect(memcmp(first, again, sizeof(fftwf_complex) * n_complex) != 0);
+
+    filter_ones(again, 1, 0, TEST_GRID_DIM, 20.0f, 0);
+    cr_expect(memcmp(first, again, sizeof(fftwf_complex) * n_complex) == 0);
+
+    // the upper half of the box as its own slab
+    filter_ones(again, 1, TEST_GRID_DIM / 2, TEST_GRID_DIM / 2, 20.0f, 0);
+    cr_expect(memcmp(first + n_half, again, sizeof(fftwf_complex) * n_half) == 0);
+
+    // two interleaved fields
+    filter_ones(again, 2, 0, TEST_GRID_DIM, 20.0f, 0);
+    for (int ii = 0; ii < n_complex; ii++) {
+        cr_expect(again[2 * ii] == first[ii]);
+        cr_expect(again[2 * ii + 1] == first[ii]);
+    }
+
+    free_filter_kernel();
+    free(again);
+    free(first);
+}
+
+#define TEST_RUN_GRID_DIM 16
+#define TEST_RUN_N_CELLS (TEST_RUN_GRID_DIM * TEST_RUN_GRID_DIM * TEST_RUN_GRID_DIM)
+#define TEST_RUN_N_SNAPS 3
+
+typedef struct test_run_outputs_t {
+    float xH[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float r_bubble[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float z_at_ionization[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float J_21[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float J_21_at_ionization[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float Gamma12[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float z_re[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float N_rec[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    float deltax[TEST_RUN_N_SNAPS][TEST_RUN_N_CELLS];
+    double volume_weighted_global_xH[TEST_RUN_N_SNAPS];
+    double mass_weighted_global_xH[TEST_RUN_N_SNAPS];
+} test_run_outputs_t;
+
+static void setup_reion_run(bool lean_memory, bool output_grids)
+{
+    int mpi_initialised;
+
+    MPI_Initialized(&mpi_initialised);
+    if (!mpi_initialised)
+        MPI_Init(NULL, NULL);
+    run_globals.mpi_comm = MPI_COMM_SELF;
+    run_globals.mpi_rank = 0;
+    run_globals.mpi_size = 1;
+
+    static double ZZ[TEST_RUN_N_SNAPS] = { 12.0, 11.0, 10.0 };
+    static int ListOutputSnaps[TEST_RUN_N_SNAPS] = { 0, 1, 2 };
+    run_globals.ZZ = ZZ;
+    run_globals.ListOutputSnaps = ListOutputSnaps;
+    run_globals.NOutputSnaps = TEST_RUN_N_SNAPS;
+    run_globals.NStoreSnapshots = 1;
+    run_globals.RhoCrit = 27.75;
+    run_globals.units.UnitMass_in_g = 1.989e43;
+    run_globals.units.UnitTime_in_s = 3.086e19;
+    run_globals.units.UnitLength_in_cm = 3.086e24;
+
+    run_params_t* params = &(run_globals.params);
+    params->Hubble_h = 0.678;
+    params->OmegaM = 0.308;
+    params->OmegaLambda = 0.692;
+    params->BaryonFrac = 0.157;
+    params->BoxSize = (double)TEST_RUN_GRID_DIM;
+    params->ReionGridDim = TEST_RUN_GRID_DIM;
+    params->Flag_PatchyReion = 1;
+    params->Flag_OutputGrids = output_grids;
+    params->Flag_IncludeRecombinations = 1;
+    params->Flag_IncludeSpinTemp = 0;
+    params->Flag_Compute21cmBrightTemp = 0;
+    params->Flag_ConstructLightcone = 0;
+    params->Flag_ComputePS = 0;
+    params->ReionUVBFlag = 1;
+    params->ReionFilterType = 0;
+    params->ReionRtoMFilterType = 0;
+    params->ReionDeltaRFactor = 1.1;
+    params->ReionNGridRanks = 0;
+    params->ReionFFTWNThreads = 1;
+    params->ReionFFTWPlannerRigor = 0;
+    params->ReionLeanMemory = lean_memory;
+    params->physics.ReionEfficiency = 10.0;
+    params->physics.ReionNionPhotPerBary = 4000.0;
+    params->physics.ReionRBubbleMax = 10.0;
+    params->physics.ReionRBubbleMaxRecomb = 10.0;
+    params->physics.ReionRBubbleMin = 0.4;
+    params->physics.ReionGammaHaloBias = 2.0;
+    params->physics.ReionAlphaUV = 5.0;
+    params->physics.Y_He = 0.24;
+
+    malloc_reionization_grids();
+}
+
+static void fill_reion_input_grids(int snapshot, float source_scale)
+{
+    // A mildly non-linear density field with a few hundred sources which grow with each snapshot
+    reion_grids_t* grids = &(run_globals.reion_grids);
+    lcg_state = 2468u + (unsigned)snapshot;
+
+    for (int ix = 0; ix < TEST_RUN_GRID_DIM; ix++)
+        for (int iy = 0; iy < TEST_RUN_GRID_DIM; iy++)
+            for (int iz = 0; iz < TEST_RUN_GRID_DIM; iz++) {
+                int i_padded = grid_index(ix, iy, iz, TEST_RUN_GRID_DIM, INDEX_PADDED);
+                float stars = (lcg_uniform() < 0.05f) ? source_scale * (float)(snapshot + 1) * lcg_uniform() : 0.0f;
+                grids->deltax[i_padded] = 1.5f * lcg_uniform() - 0.5f;
+                grids->stars[i_padded] = stars;
+                grids->sfr[i_padded] = 5.0f * stars;
+            }
+}
+
+static void run_reion_snapshots(bool lean_memory, float source_scale, bool output_grids, test_run_outputs_t* out)
+{
+    reion_grids_t* grids = &(run_globals.reion_grids);
+
+    setup_reion_run(lean_memory, output_grids);
+
+    for (int snapshot = 0; snapshot < TEST_RUN_N_SNAPS; snapshot++) {
+        fill_reion_input_grids(snapshot, source_scale);
+        _find_HII_bubbles(snapshot);
+
+        memcpy(out->xH[snapshot], grids->xH, sizeof(float) * TEST_RUN_N_CELLS);
+        memcpy(out->r_bubble[snapshot], grids->r_bubble, sizeof(float) * TEST_RUN_N_CELLS);
+        memcpy(out->z_at_ionization[snapshot], grids->z_at_ionization, sizeof(float) * TEST_RUN_N_CELLS);
+        memcpy(out->J_21[snapshot], grids->J_21, sizeof(float) * TEST_RUN_N_CELLS);
+        memcpy(out->J_21_at_ionization[snapshot], grids->J_21_at_ionization, sizeof(float) * TEST_RUN_N_CELLS);
+        memcpy(out->Gamma12[snapshot], grids->Gamma12, sizeof(float) * TEST_RUN_N_CELLS);
+        memcpy(out->z_re[snapshot], grids->z_re, sizeof(float) * TEST_RUN_N_CELLS);
+        for (int ii = 0; ii < TEST_RUN_N_CELLS; ii++) {
+            int ix = ii / (TEST_RUN_GRID_DIM * TEST_RUN_GRID_DIM);
+            int iy = (ii / TEST_RUN_GRID_DIM) % TEST_RUN_GRID_DIM;
+            int iz = ii % TEST_RUN_GRID_DIM;
+            int i_padded = grid_index(ix, iy, iz, TEST_RUN_GRID_DIM, INDEX_PADDED);
+            out->N_rec[snapshot][ii] = grids->N_rec[i_padded];
+            out->deltax[snapshot][ii] = grids->deltax[i_padded];
+        }
+        out->volume_weighted_global_xH[snapshot] = grids->volume_weighted_global_xH;
+        out->mass_weighted_global_xH[snapshot] = grids->mass_weighted_global_xH;
+    }
+
+    free_reionization_grids();
+    free(run_globals.SnapshotDeltax);
+    free(run_globals.SnapshotVel);
+}
+
+Test(find_HII_bubbles, lean_memory_gives_identical_fields)
+{
+    test_run_outputs_t* lean = calloc(1, sizeof(test_run_outputs_t));
+    test_run_outputs_t* reference = calloc(1, sizeof(test_run_outputs_t));
+
+    run_reion_snapshots(false, 8.0f, true, reference);
+    run_reion_snapshots(true, 8.0f, true, lean);
+
+    // make sure the test actually covers partial reionization with recombinations
+    int n_ionised = 0;
+    int n_recombined = 0;
+    for (int ii = 0; ii < TEST_RUN_N_CELLS; ii++) {
+        n_ionised += (reference->xH[TEST_RUN_N_SNAPS - 1][ii] == 0);
+        n_recombined += (reference->N_rec[TEST_RUN_N_SNAPS - 1][ii] > 0);
+    }
+    cr_assert(n_ionised > 0);
+    cr_assert(n_ionised < TEST_RUN_N_CELLS);
+    cr_assert(n_recombined > 0);
+
+    cr_expect(memcmp(lean->xH, reference->xH, sizeof(lean->xH)) == 0, "xH differs");
+    cr_expect(memcmp(lean->r_bubble, reference->r_bubble, sizeof(lean->r_bubble)) == 0, "r_bubble differs");
+    cr_expect(memcmp(lean->z_at_ionization, reference->z_at_ionization, sizeof(lean->z_at_ionization)) == 0,
+        "z_at_ionization differs");
+    cr_expect(memcmp(lean->J_21, reference->J_21, sizeof(lean->J_21)) == 0, "J_21 differs");
+    cr_expect(memcmp(lean->J_21_at_ionization, reference->J_21_at_ionization, sizeof(lean->J_21_at_ionization)) == 0,
+        "J_21_at_ionization differs");
+    cr_expect(memcmp(lean->Gamma12, reference->Gamma12, sizeof(lean->Gamma12)) == 0, "Gamma12 differs");
+    cr_expect(memcmp(lean->z_re, reference->z_re, sizeof(lean->z_re)) == 0, "z_re differs");
+    cr_expect(memcmp(lean->N_rec, reference->N_rec, sizeof(lean->N_rec)) == 0, "N_rec differs");
+    cr_expect(memcmp(lean->volume_weighted_global_xH, reference->volume_weighted_global_xH,
+                  sizeof(lean->volume_weighted_global_xH)) == 0, "volume weighted xH differs");
+    cr_expect(memcmp(lean->mass_weighted_global_xH, reference->mass_weighted_global_xH,
+                  sizeof(lean->mass_weighted_global_xH)) == 0, "mass weighted xH differs");
+
+    // deltax is still needed in real space after the call (e.g. for the brightness temperature)
+    cr_expect(memcmp(lean->deltax, reference->deltax, sizeof(lean->deltax)) == 0, "deltax differs");
+
+    free(reference);
+    free(lean);
+}
+
+Test(find_HII_bubbles, exit_once_every_cell_is_ionised_is_exact)
+{
+    // Bright enough that every cell is ionised before the smallest radius at the last snapshot.  When the grids
+    // aren't being output the filter loop stops there, which can only leave r_bubble different.
+    test_run_outputs_t* early = calloc(1, sizeof(test_run_outputs_t));
+    test_run_outputs_t* reference = calloc(1, sizeof(test_run_outputs_t));
+
+    run_reion_snapshots(false, 8.0f, true, reference);
+    run_reion_snapshots(false, 8.0f, false, early);
+    cr_expect(memcmp(early, reference, sizeof(test_run_outputs_t)) == 0, "partially ionised box differs");
+
+    run_reion_snapshots(false, 1000.0f, true, reference);
+    run_reion_snapshots(false, 1000.0f, false, early);
+
+    for (int ii = 0; ii < TEST_RUN_N_CELLS; ii++)
+        cr_assert(reference->xH[TEST_RUN_N_SNAPS - 1][ii] == 0);
+    cr_expect(memcmp(early->r_bubble, reference->r_bubble, sizeof(early->r_bubble)) != 0, "the loop didn't stop early");
+
+    memcpy(early->r_bubble, reference->r_bubble, sizeof(early->r_bubble));
+    cr_expect(memcmp(early, reference, sizeof(test_run_outputs_t)) == 0, "fully ionised box differs");
+
+    free(reference);
+    free(early);
+}